@@ -56,6 +56,11 @@ std::shared_ptr<ColorSampler> Assignment5::CreateSampler() const
     // ASSIGNMENT 5 TODO: Change the '1.f' in '1.f * SMALL_EPSILON' here to be higher and see what your results are. (Part 3)
     sampler->SetEarlyExitParameters(1.f * SMALL_EPSILON,16);
 
+    // SobolColorSampler or HaltonColorSampler can replace the jitter sampler (also as the adaptive sampler's internal
+    // sampler); they reach the same noise level with fewer samples per pixel.
+    // VarianceAdaptiveSampler (with SetSampleBudget) instead spends an average number of samples per pixel where the
+    // image is noisiest, using GetSamplesPerPixel() as the per-pixel cap.
+
     // ASSIGNMENT 5 TODO: Comment out 'return jitter;' to use the adaptive sampler. (Part 2)
     return jitter;
     return sampler;
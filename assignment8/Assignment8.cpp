@@ -1,6 +1,11 @@
 #include "assignment8/Assignment8.h"
 #include "common/core.h"
 
+Assignment8::Assignment8(SceneType inputSceneType) :
+    sceneType(inputSceneType)
+{
+}
+
 std::shared_ptr<Camera> Assignment8::CreateCamera() const
 {
     const glm::vec2 resolution = GetImageOutputResolution();
@@ -14,17 +19,39 @@ std::shared_ptr<Scene> Assignment8::CreateScene() const
 {
     std::shared_ptr<Scene> newScene = std::make_shared<Scene>();
 
-/* sphere
+    std::vector<std::shared_ptr<MeshObject>> cubeObjects = (sceneType == SceneType::SPHERES) ? LoadSphereBox() : LoadCubeBox();
+
+    std::shared_ptr<SceneObject> cubeSceneObject = std::make_shared<SceneObject>();
+    cubeSceneObject->AddMeshObject(cubeObjects);
+    cubeSceneObject->Rotate(glm::vec3(1.f, 0.f, 0.f), PI / 2.f);
+    cubeSceneObject->CreateAccelerationData(AccelerationTypes::BVH);
+    newScene->AddSceneObject(cubeSceneObject);
+  
+    // Lights
+    std::shared_ptr<PointLight> pointLight = std::make_shared<PointLight>();  
+    //std::shared_ptr<AreaLight> pointLight = std::make_shared<AreaLight>(glm::vec2(0.5f, 0.5f));
+    //pointLight->SetSamplerAttributes(glm::vec3(5.f, 5.f, 1.f), 25);
+    pointLight->SetPosition(glm::vec3(-0.005f,-0.01f, 1.5328f));
+    pointLight->SetLightColor(glm::vec3(1.f, 1.f, 1.f));
+    newScene->AddLight(pointLight);
+    
+    return newScene;
+
+}
+
+std::vector<std::shared_ptr<MeshObject>> Assignment8::LoadSphereBox() const
+{
     // Material
     std::shared_ptr<BlinnPhongMaterial> cubeMaterial = std::make_shared<BlinnPhongMaterial>();
     cubeMaterial->SetDiffuse(glm::vec3(0.6f, 0.6f, 0.6f));
     cubeMaterial->SetSpecular(glm::vec3(0.4f, 0.4f, 0.4f), 40.f);
     cubeMaterial->SetAmbient(glm::vec3(0.f,0.f,0.f));
-    
-    // Objects
+
+    // Objects. The two spheres come first and are tessellated finely enough to be swapped for analytic spheres.
     std::vector<std::shared_ptr<aiMaterial>> loadedMaterials;
-    std::vector<std::shared_ptr<MeshObject>> cubeObjects = MeshLoader::LoadMesh("CornellBox/CornellBox-Sphere.obj", &loadedMaterials);
-    std::cout<<cubeObjects.size()<<std::endl;
+    MeshLoader::MeshLoadOptions loadOptions;
+    loadOptions.replaceSpheres = true;
+    std::vector<std::shared_ptr<MeshObject>> cubeObjects = MeshLoader::LoadMesh("CornellBox/CornellBox-Sphere.obj", &loadedMaterials, loadOptions);
     for (size_t i = 0; i < 2; ++i) {
         std::shared_ptr<Material> materialCopy = cubeMaterial->Clone();
         materialCopy->LoadMaterialFromAssimp(loadedMaterials[i]);
@@ -39,8 +66,11 @@ std::shared_ptr<Scene> Assignment8::CreateScene() const
         materialCopy->LoadMaterialFromAssimp(loadedMaterials[i]);
         cubeObjects[i]->SetMaterial(materialCopy);
     }
-*/
-// cube
+    return cubeObjects;
+}
+
+std::vector<std::shared_ptr<MeshObject>> Assignment8::LoadCubeBox() const
+{
     // Material
     std::shared_ptr<BlinnPhongMaterial> cubeMaterial = std::make_shared<BlinnPhongMaterial>();
     cubeMaterial->SetDiffuse(glm::vec3(1.f, 1.f, 1.f));
@@ -54,24 +84,9 @@ std::shared_ptr<Scene> Assignment8::CreateScene() const
         materialCopy->LoadMaterialFromAssimp(loadedMaterials[i]);
         cubeObjects[i]->SetMaterial(materialCopy);
     }
-    
-    std::shared_ptr<SceneObject> cubeSceneObject = std::make_shared<SceneObject>();
-    cubeSceneObject->AddMeshObject(cubeObjects);
-    cubeSceneObject->Rotate(glm::vec3(1.f, 0.f, 0.f), PI / 2.f);
-    cubeSceneObject->CreateAccelerationData(AccelerationTypes::BVH);
-    newScene->AddSceneObject(cubeSceneObject);
-  
-    // Lights
-    std::shared_ptr<PointLight> pointLight = std::make_shared<PointLight>();  
-    //std::shared_ptr<AreaLight> pointLight = std::make_shared<AreaLight>(glm::vec2(0.5f, 0.5f));
-    //pointLight->SetSamplerAttributes(glm::vec3(5.f, 5.f, 1.f), 25);
-    pointLight->SetPosition(glm::vec3(-0.005f,-0.01f, 1.5328f));
-    pointLight->SetLightColor(glm::vec3(1.f, 1.f, 1.f));
-    newScene->AddLight(pointLight);
-    
-    return newScene;
-
+    return cubeObjects;
 }
+
 std::shared_ptr<ColorSampler> Assignment8::CreateSampler() const
 {
     std::shared_ptr<JitterColorSampler> jitter = std::make_shared<JitterColorSampler>();
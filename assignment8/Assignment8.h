@@ -5,6 +5,17 @@
 class Assignment8 : public Application
 {
 public:
+    enum class SceneType
+    {
+        // Jensen's Cornell box with two glass spheres, loaded with MeshLoadOptions::replaceSpheres so that the spheres
+        // are traced as analytic Sphere primitives.
+        SPHERES,
+        // The Cornell box with the two textured boxes.
+        BOXES
+    };
+
+    Assignment8(SceneType inputSceneType = SceneType::SPHERES);
+
     virtual std::shared_ptr<class Camera> CreateCamera() const override;
     virtual std::shared_ptr<class Scene> CreateScene() const override;
     virtual std::shared_ptr<class ColorSampler> CreateSampler() const override;
@@ -14,4 +25,9 @@ public:
     virtual int GetMaxReflectionBounces() const override;
     virtual int GetMaxRefractionBounces() const override;
     virtual glm::vec2 GetImageOutputResolution() const override;
+private:
+    std::vector<std::shared_ptr<class MeshObject>> LoadSphereBox() const;
+    std::vector<std::shared_ptr<class MeshObject>> LoadCubeBox() const;
+
+    SceneType sceneType;
 };
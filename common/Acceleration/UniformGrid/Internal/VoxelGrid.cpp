@@ -95,10 +95,40 @@ bool VoxelGrid::Trace(const SceneObject* parentObject, Ray* inputRay, Intersecti
     std::cout << "Scene Bounding: " << glm::to_string(boundingBox.minVertex) << " " << glm::to_string(boundingBox.maxVertex) << std::endl;
     std::cout << "Voxel Size: " << glm::to_string(voxelSize) << std::endl;
 #endif
+    // Shadow queries need every hit up to the end of the ray, not just the first voxel with a hit.
+    ShadowTransmittance* shadowTransmittance = outputIntersection ? outputIntersection->shadowTransmittance : nullptr;
+    const float outerHitMinT = shadowTransmittance ? shadowTransmittance->GetHitRangeMinT() : 0.f;
+    const float outerHitMaxT = shadowTransmittance ? shadowTransmittance->GetHitRangeMaxT() : 0.f;
+    float voxelEnterT = std::numeric_limits<float>::lowest();
+    bool hitAnyVoxel = false;
     while (IsInsideGrid(currentVoxelIndex)) {
 #if DEBUG_VOXEL_GRID
         std::cout << "Trace Voxel: " << glm::to_string(currentVoxelIndex) << std::endl;
 #endif
+        if (shadowTransmittance) {
+            int minIndex = 0;
+            float minTMax = 0.f;
+            FindClosestVoxelSide(minIndex, minTMax, currentVoxelIndex, step, rayPos, rayDir);
+            assert(minIndex >= 0);
+            glm::ivec3 nextVoxelIndex = currentVoxelIndex;
+            nextVoxelIndex[minIndex] += step[minIndex];
+            const bool lastVoxel = !IsInsideGrid(nextVoxelIndex) || minTMax - inputRay->GetMaxT() > SMALL_EPSILON;
+
+            // Primitives that straddle several voxels are tested in each of them; only crossings within the current
+            // voxel count, so every crossing counts once. The ends of the ray stay open so that rounding at the grid
+            // boundary loses nothing, and the range of an enclosing grid still applies.
+            const float voxelExitT = lastVoxel ? std::numeric_limits<float>::max() : minTMax;
+            shadowTransmittance->SetHitRange(std::max(voxelEnterT, outerHitMinT), std::min(voxelExitT, outerHitMaxT));
+            hitAnyVoxel |= grid[currentVoxelIndex[0]][currentVoxelIndex[1]][currentVoxelIndex[2]].Trace(parentObject, inputRay, outputIntersection);
+            if (shadowTransmittance->IsBlocked() || lastVoxel) {
+                hitAnyVoxel |= shadowTransmittance->IsBlocked();
+                break;
+            }
+            voxelEnterT = minTMax;
+            currentVoxelIndex = nextVoxelIndex;
+            continue;
+        }
+
         IntersectionState tempIntersection;
         tempIntersection.TestAndCopyLimits(outputIntersection);
         bool hitVoxel = grid[currentVoxelIndex[0]][currentVoxelIndex[1]][currentVoxelIndex[2]].Trace(parentObject, inputRay, &tempIntersection);
@@ -128,7 +158,10 @@ bool VoxelGrid::Trace(const SceneObject* parentObject, Ray* inputRay, Intersecti
         std::cout << " -- next voxel: " << glm::to_string(currentVoxelIndex) << " " << minIndex << " " << minTMax << std::endl;
 #endif
     }
-    return false;
+    if (shadowTransmittance) {
+        shadowTransmittance->SetHitRange(outerHitMinT, outerHitMaxT);
+    }
+    return hitAnyVoxel;
 }
 
 void VoxelGrid::FindClosestVoxelSide(int& dim, float& t, const glm::ivec3& currentVoxelIndex, const glm::ivec3& step, const glm::vec3& rayPos, const glm::vec3& rayDir) const
@@ -7,6 +7,16 @@ std::string Application::GetOutputFilename() const
     return "output.png";
 }
 
+float Application::GetMinimumRayContribution() const
+{
+    return 0.f;
+}
+
+bool Application::UseRussianRoulette() const
+{
+    return false;
+}
+
 int Application::GetSamplesPerPixel() const
 {
     return 16;
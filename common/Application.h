@@ -17,6 +17,11 @@ public:
     virtual int GetMaxReflectionBounces() const = 0;
     virtual int GetMaxRefractionBounces() const = 0;
 
+    // Reflection/refraction rays that would contribute less than this (see Scene::SetSecondaryRayCulling). Off by
+    // default; applications opt in by overriding these.
+    virtual float GetMinimumRayContribution() const;
+    virtual bool UseRussianRoulette() const;
+
     // output
     virtual glm::vec2 GetImageOutputResolution() const;
 
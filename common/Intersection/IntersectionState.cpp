@@ -1,12 +1,89 @@
 #include "common/Intersection/IntersectionState.h"
 #include "common/Scene/Geometry/Primitives/PrimitiveBase.h"
+#include "common/Scene/Geometry/Mesh/MeshObject.h"
+#include "common/Rendering/Material/Material.h"
+
+ShadowTransmittance::ShadowTransmittance() :
+    transmittance(1.f), blocked(false), hitRangeMinT(std::numeric_limits<float>::lowest()), hitRangeMaxT(std::numeric_limits<float>::max())
+{
+}
+
+void ShadowTransmittance::AddHit(const PrimitiveBase* primitive, float t, Ray* inputRay)
+{
+    if (blocked || t < hitRangeMinT || t >= hitRangeMaxT) {
+        return;
+    }
+
+    const MeshObject* hitMesh = primitive->GetParentMeshObject();
+    assert(hitMesh);
+    const Material* hitMaterial = hitMesh->GetMaterial();
+    assert(hitMaterial);
+    if (!hitMaterial->IsTransmissive()) {
+        transmittance = glm::vec3(0.f);
+        blocked = true;
+        inputRay->SetMaxT(std::numeric_limits<float>::lowest());
+        return;
+    }
+
+    // Every surface crossing lets through the square root, so entering and leaving an object gives its transmittance.
+    const glm::vec3 surfaceTransmittance = hitMaterial->GetBaseTransmittance();
+    transmittance *= glm::vec3(std::sqrt(surfaceTransmittance.x), std::sqrt(surfaceTransmittance.y), std::sqrt(surfaceTransmittance.z));
+}
+
+const ShadingFrame& IntersectionState::GetShadingFrame() const
+{
+    const glm::vec3 position = intersectionRay.GetRayPosition(intersectionT);
+    if (shadingFramePrimitive != intersectedPrimitive || shadingFrameParent != primitiveParent || shadingFrame.position != position) {
+        ComputeShadingFrame();
+        shadingFramePrimitive = intersectedPrimitive;
+        shadingFrameParent = primitiveParent;
+    }
+    return shadingFrame;
+}
 
 glm::vec3 IntersectionState::ComputeNormal() const
+{
+    return GetShadingFrame().normal;
+}
+
+glm::vec2 IntersectionState::ComputeUV() const
+{
+    return GetShadingFrame().uv;
+}
+
+glm::vec3 IntersectionState::ComputePosition() const
+{
+    return GetShadingFrame().position;
+}
+
+void IntersectionState::ComputeShadingFrame() const
 {
     assert(hasIntersection && intersectedPrimitive && primitiveParent);
     assert(primitiveIntersectionWeights.size() == static_cast<size_t>(intersectedPrimitive->GetTotalVertices()));
 
-    const glm::mat3 normalTransform = glm::mat3(glm::transpose(glm::inverse(primitiveParent->GetObjectToWorldMatrix())));
+    const glm::mat3 normalTransform = primitiveParent->GetObjectToWorldNormalMatrix();
+    shadingFrame.position = intersectionRay.GetRayPosition(intersectionT);
+
+    if (intersectedPrimitive->IsAnalytic()) {
+        const glm::vec3 objectPosition = ComputeObjectSpacePosition();
+        glm::vec3 normal, tangent, bitangent;
+        intersectedPrimitive->ComputeAnalyticFrame(objectPosition, normal, tangent, bitangent);
+        shadingFrame.uv = intersectedPrimitive->ComputeAnalyticUV(objectPosition);
+        shadingFrame.tangent = normalTransform * tangent;
+        shadingFrame.bitangent = normalTransform * bitangent;
+        shadingFrame.normal = normalTransform * normal;
+        if (intersectedPrimitive->HasNormalMap()) {
+            shadingFrame.normal = intersectedPrimitive->GetVertexNormalMap(shadingFrame.uv, shadingFrame.tangent, shadingFrame.bitangent, shadingFrame.normal);
+        }
+        shadingFrame.normal = glm::normalize(shadingFrame.normal);
+        return;
+    }
+
+    glm::vec2 retUV;
+    for (int i = 0; i < intersectedPrimitive->GetTotalVertices(); ++i) {
+        retUV += primitiveIntersectionWeights[i] * intersectedPrimitive->GetVertexUV(i);
+    }
+    shadingFrame.uv = retUV;
 
     if (intersectedPrimitive->HasVertexNormals()) {
         // If the mesh has normals, linearly interpolate the normals to get the normal to use.
@@ -18,26 +95,25 @@ glm::vec3 IntersectionState::ComputeNormal() const
             retTangent += primitiveIntersectionWeights[i] * normalTransform* intersectedPrimitive->GetVertexTangent(i);
             retBitangent += primitiveIntersectionWeights[i] * normalTransform * intersectedPrimitive->GetVertexBitangent(i);
         }
+        shadingFrame.tangent = retTangent;
+        shadingFrame.bitangent = retBitangent;
 
         if (intersectedPrimitive->HasNormalMap()) {
-            return glm::normalize(intersectedPrimitive->GetVertexNormalMap(ComputeUV(), retTangent, retBitangent, retNormal));
+            shadingFrame.normal = glm::normalize(intersectedPrimitive->GetVertexNormalMap(retUV, retTangent, retBitangent, retNormal));
+        } else {
+            shadingFrame.normal = glm::normalize(retNormal);
         }
-
-        return glm::normalize(retNormal);
+        return;
     }
 
     // Otherwise, use the face normal.
-    return glm::normalize(normalTransform * intersectedPrimitive->GetPrimitiveNormal());
+    shadingFrame.tangent = glm::vec3();
+    shadingFrame.bitangent = glm::vec3();
+    shadingFrame.normal = glm::normalize(normalTransform * intersectedPrimitive->GetPrimitiveNormal());
 }
 
-glm::vec2 IntersectionState::ComputeUV() const
+glm::vec3 IntersectionState::ComputeObjectSpacePosition() const
 {
-    assert(hasIntersection && intersectedPrimitive && primitiveParent);
-    assert(primitiveIntersectionWeights.size() == static_cast<size_t>(intersectedPrimitive->GetTotalVertices()));
-
-    glm::vec2 retUV;
-    for (int i = 0; i < intersectedPrimitive->GetTotalVertices(); ++i) {
-        retUV += primitiveIntersectionWeights[i] * intersectedPrimitive->GetVertexUV(i);
-    }
-    return retUV;
-}
\ No newline at end of file
+    assert(hasIntersection && primitiveParent);
+    return glm::vec3(primitiveParent->GetWorldToObjectMatrix() * glm::vec4(intersectionRay.GetRayPosition(intersectionT), 1.f));
+}
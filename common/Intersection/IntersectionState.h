@@ -3,15 +3,111 @@
 #include "common/common.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
 
+// Per-vertex interpolation weights of a hit, stored inline so that recording an intersection never allocates. Mirrors
+// the parts of std::vector the primitives use.
+class IntersectionWeights
+{
+public:
+    // Enough for every primitive type (quads have the most vertices).
+    static const int MAX_WEIGHTS = 4;
+
+    IntersectionWeights() :
+        totalWeights(0)
+    {
+    }
+
+    void clear()
+    {
+        totalWeights = 0;
+    }
+
+    void emplace_back(float weight)
+    {
+        assert(totalWeights < MAX_WEIGHTS);
+        weights[totalWeights++] = weight;
+    }
+
+    size_t size() const
+    {
+        return static_cast<size_t>(totalWeights);
+    }
+
+    float operator[](size_t index) const
+    {
+        assert(index < size());
+        return weights[index];
+    }
+private:
+    std::array<float, MAX_WEIGHTS> weights;
+    int totalWeights;
+};
+
+// Everything shading needs to know about a hit, in world space.
+struct ShadingFrame
+{
+    glm::vec3 position;
+    // Interpolated (or face) normal with the normal map applied.
+    glm::vec3 normal;
+    glm::vec3 tangent;
+    glm::vec3 bitangent;
+    glm::vec2 uv;
+};
+
+// Collects every hit along a shadow ray instead of only the closest one; see Scene::ComputeShadowTransmittance.
+// Primitives pass their hits to AddHit when the IntersectionState they trace into carries one.
+class ShadowTransmittance
+{
+public:
+    ShadowTransmittance();
+
+    // Multiplies in the transmittance of the surface that was hit. An opaque surface blocks the ray and shortens it to
+    // nothing, so that the rest of the traversal bails out right away.
+    void AddHit(const class PrimitiveBase* primitive, float t, class Ray* inputRay);
+
+    bool IsBlocked() const
+    {
+        return blocked;
+    }
+
+    const glm::vec3& GetTransmittance() const
+    {
+        return transmittance;
+    }
+
+    // Hits with t outside [minT, maxT) are ignored. Accelerations that test a primitive more than once along the ray,
+    // like a uniform grid for primitives that straddle several cells, narrow this down to the part of the ray they are
+    // looking at so that every crossing counts exactly once. Everything is accepted by default.
+    void SetHitRange(float minT, float maxT)
+    {
+        hitRangeMinT = minT;
+        hitRangeMaxT = maxT;
+    }
+
+    float GetHitRangeMinT() const
+    {
+        return hitRangeMinT;
+    }
+
+    float GetHitRangeMaxT() const
+    {
+        return hitRangeMaxT;
+    }
+private:
+    glm::vec3 transmittance;
+    bool blocked;
+    float hitRangeMinT;
+    float hitRangeMaxT;
+};
+
 struct IntersectionState
 {
     IntersectionState() :
-        reflectionIntersection(nullptr), remainingReflectionBounces(0), refractionIntersection(nullptr), remainingRefractionBounces(0), intersectionT(std::numeric_limits<float>::max()), hasIntersection(false), currentIOR(1.f)
+        reflectionIntersection(nullptr), remainingReflectionBounces(0), refractionIntersection(nullptr), remainingRefractionBounces(0), intersectionT(std::numeric_limits<float>::max()), hasIntersection(false), currentIOR(1.f), pathThroughput(1.f), russianRouletteWeight(1.f), shadowTransmittance(nullptr), shadingFramePrimitive(nullptr), shadingFrameParent(nullptr)
     {
     }
 
     IntersectionState(int reflectionBounces, int refractionBounces) :
-        reflectionIntersection(nullptr), remainingReflectionBounces(reflectionBounces), refractionIntersection(nullptr), remainingRefractionBounces(refractionBounces), intersectionT(std::numeric_limits<float>::max()), hasIntersection(false), currentIOR(1.f)
+        reflectionIntersection(nullptr), remainingReflectionBounces(reflectionBounces), refractionIntersection(nullptr), remainingRefractionBounces(refractionBounces), intersectionT(std::numeric_limits<float>::max()), hasIntersection(false), currentIOR(1.f), pathThroughput(1.f), russianRouletteWeight(1.f), shadowTransmittance(nullptr), shadingFramePrimitive(nullptr), shadingFrameParent(nullptr)
     {
     }
 
@@ -24,25 +120,56 @@ struct IntersectionState
         remainingRefractionBounces = state->remainingRefractionBounces;
         intersectionT = state->intersectionT;
         currentIOR = state->currentIOR;
+        pathThroughput = state->pathThroughput;
+        russianRouletteWeight = state->russianRouletteWeight;
     }
 
-    std::shared_ptr<struct IntersectionState> reflectionIntersection;
+    // Secondary hits, filled in on demand by Scene::TraceReflection/TraceRefraction. They live in the
+    // IntersectionStateArena of the thread that traced them and are only valid until that arena is reset.
+    mutable struct IntersectionState* reflectionIntersection;
     int remainingReflectionBounces;
 
-    std::shared_ptr<struct IntersectionState> refractionIntersection;
+    mutable struct IntersectionState* refractionIntersection;
     int remainingRefractionBounces;
 
     const class PrimitiveBase* intersectedPrimitive;
     const class SceneObject* primitiveParent;
+
+    // Keeps streamed geometry in memory while intersectedPrimitive points into it. Empty for regular meshes.
+    std::shared_ptr<const void> intersectedPrimitiveOwner;
     Ray intersectionRay;
     float intersectionT;
     bool hasIntersection;
     float currentIOR;
 
+    // Product of the reflectivities/transmittances along the ray tree from the camera to this state (including any
+    // Russian roulette compensation); see Scene::SetSecondaryRayCulling.
+    glm::vec3 pathThroughput;
+
+    // 1 / survival probability if this state survived Russian roulette. Whatever is computed from it has to be scaled by
+    // this to stay unbiased.
+    float russianRouletteWeight;
+
     // One for each vertex
-    std::vector<float> primitiveIntersectionWeights;
+    IntersectionWeights primitiveIntersectionWeights;
+
+    // Set for shadow queries: hits go here instead of being recorded in the state.
+    ShadowTransmittance* shadowTransmittance;
 
-    // Utility Functions
+    // Utility Functions. The shading frame is computed the first time any of these is called for a hit and reused until
+    // the state records a different hit.
+    const ShadingFrame& GetShadingFrame() const;
     glm::vec3 ComputeNormal() const;
     glm::vec2 ComputeUV() const;
+    glm::vec3 ComputePosition() const;
+    glm::vec3 ComputeObjectSpacePosition() const;
+
+private:
+    void ComputeShadingFrame() const;
+
+    // The hit the cached frame belongs to (together with shadingFrame.position). Primitives fill in the hit directly, so
+    // the cache is validated against it instead of being invalidated explicitly.
+    mutable const class PrimitiveBase* shadingFramePrimitive;
+    mutable const class SceneObject* shadingFrameParent;
+    mutable ShadingFrame shadingFrame;
 };
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "common/Intersection/IntersectionStateArena.h"
+
+const size_t IntersectionStateArena::MAX_RESERVED_STATES = 4096;
+
+IntersectionStateArena::IntersectionStateArena() :
+    totalAllocated(0)
+{
+}
+
+IntersectionStateArena& IntersectionStateArena::GetThreadArena()
+{
+    static thread_local IntersectionStateArena arena;
+    return arena;
+}
+
+size_t IntersectionStateArena::ComputeMaxTreeSize(int maxReflectionBounces, int maxRefractionBounces)
+{
+    // A node is reached by some ordering of r reflections and t refractions, so there are C(r + t, r) nodes for each
+    // (r, t) pair. Saturate instead of overflowing on silly limits.
+    const double limit = static_cast<double>(std::numeric_limits<size_t>::max());
+    double totalNodes = 0.0;
+    for (int r = 0; r <= std::max(maxReflectionBounces, 0); ++r) {
+        double binomial = 1.0;
+        for (int t = 0; t <= std::max(maxRefractionBounces, 0); ++t) {
+            if (t > 0) {
+                binomial = binomial * (r + t) / t;
+            }
+            totalNodes += binomial;
+        }
+    }
+    return (totalNodes - 1.0 >= limit) ? std::numeric_limits<size_t>::max() : static_cast<size_t>(totalNodes - 1.0);
+}
+
+void IntersectionStateArena::Reserve(int maxReflectionBounces, int maxRefractionBounces)
+{
+    const size_t requiredStates = std::min(ComputeMaxTreeSize(maxReflectionBounces, maxRefractionBounces), MAX_RESERVED_STATES);
+    while (states.size() < requiredStates) {
+        states.emplace_back();
+    }
+}
+
+IntersectionState* IntersectionStateArena::Allocate(int reflectionBounces, int refractionBounces)
+{
+    if (totalAllocated == states.size()) {
+        // A deque never moves its elements when growing at the end so the states handed out earlier stay valid.
+        states.emplace_back();
+    }
+
+    IntersectionState* state = &states[totalAllocated++];
+    *state = IntersectionState(reflectionBounces, refractionBounces);
+    return state;
+}
+
+void IntersectionStateArena::Reset()
+{
+    // The states stay allocated, but whatever they keep alive must not be: a parked state would otherwise pin a streamed
+    // chunk until the next ray tree that happens to be this deep.
+    for (size_t i = 0; i < totalAllocated; ++i) {
+        states[i].intersectedPrimitiveOwner.reset();
+    }
+    totalAllocated = 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Intersection/IntersectionState.h"
+#include <deque>
+
+// Storage for the reflection and refraction states that Scene::Trace hangs off the root IntersectionState. Every thread
+// has its own arena; states are handed out in order and only reclaimed all at once by Reset(), which has to happen
+// before each new camera sample. Once the arena has grown to the largest ray tree seen, tracing does not allocate.
+class IntersectionStateArena
+{
+public:
+    IntersectionStateArena();
+
+    static IntersectionStateArena& GetThreadArena();
+
+    // Number of secondary states a full ray tree with the given bounce limits needs (the root is not included).
+    static size_t ComputeMaxTreeSize(int maxReflectionBounces, int maxRefractionBounces);
+
+    // Preallocates room for a full ray tree with the given limits, up to MAX_RESERVED_STATES. Deeper trees still work;
+    // the arena then grows while the first few samples are traced.
+    void Reserve(int maxReflectionBounces, int maxRefractionBounces);
+
+    IntersectionState* Allocate(int reflectionBounces, int refractionBounces);
+
+    // Invalidates every state handed out so far and releases the geometry they kept alive.
+    void Reset();
+
+    size_t GetTotalAllocated() const { return totalAllocated; }
+    size_t GetCapacity() const { return states.size(); }
+
+    static const size_t MAX_RESERVED_STATES;
+private:
+    std::deque<IntersectionState> states;
+    size_t totalAllocated;
+};
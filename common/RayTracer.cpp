@@ -4,6 +4,7 @@
 #include "common/Scene/Camera/Camera.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
 #include "common/Intersection/IntersectionState.h"
+#include "common/Intersection/IntersectionStateArena.h"
 #include "common/Sampling/ColorSampler.h"
 #include "common/Output/ImageWriter.h"
 #include "common/Rendering/Renderer.h"
@@ -26,6 +27,9 @@ void RayTracer::Run()
     std::shared_ptr<Renderer> currentRenderer = storedApplication->CreateRenderer(currentScene, currentSampler);
     assert(currentScene && currentCamera && currentSampler && currentRenderer);
 
+    currentScene->SetSecondaryRayCulling(storedApplication->GetMinimumRayContribution(), storedApplication->UseRussianRoulette());
+    DIAGNOSTICS_LOG("Minimum secondary ray contribution: " + std::to_string(storedApplication->GetMinimumRayContribution()) +
+        (storedApplication->UseRussianRoulette() ? " (Russian roulette)" : ""));
     currentSampler->InitializeSampler(storedApplication.get(), currentScene.get());
     std::cout<<"RayTracer.run::finish scene setup"<<std::endl;
     
@@ -46,49 +50,61 @@ void RayTracer::Run()
     const int maxSamplesPerPixel = storedApplication->GetSamplesPerPixel();
     assert(maxSamplesPerPixel >= 1);
 
-    for (int r = 0; r < static_cast<int>(currentResolution.y); ++r) {
-        for (int c = 0; c < static_cast<int>(currentResolution.x); ++c) {
-            imageWriter.SetPixelColor(currentSampler->ComputeSamplesAndColor(maxSamplesPerPixel, 2, [&](glm::vec3 inputSample) {
+    // The secondary rays of each sample are kept in this arena; it is reset before every camera ray.
+    IntersectionStateArena& intersectionArena = IntersectionStateArena::GetThreadArena();
+    intersectionArena.Reserve(storedApplication->GetMaxReflectionBounces(), storedApplication->GetMaxRefractionBounces());
+
+    // Some renderers compute the whole image themselves; all others are sampled pixel by pixel.
+    const bool renderedByRenderer = currentRenderer->ComputeImage(*storedApplication, *currentCamera, [&](int c, int r, glm::vec3 pixelColor) {
+        imageWriter.SetPixelColor(pixelColor, c, r);
+    });
+    if (!renderedByRenderer) {
+        currentSampler->ComputeImage(static_cast<int>(currentResolution.x), static_cast<int>(currentResolution.y), maxSamplesPerPixel, 2,
+            [&](int c, int r, glm::vec3 inputSample) {
                 const glm::vec3 minRange(-0.5f, -0.5f, 0.f);
                 const glm::vec3 maxRange(0.5f, 0.5f, 0.f);
                 const glm::vec3 sampleOffset = (maxSamplesPerPixel == 1) ? glm::vec3(0.f, 0.f, 0.f) : minRange + (maxRange - minRange) * inputSample;
 
                 glm::vec2 normalizedCoordinates(static_cast<float>(c) + sampleOffset.x, static_cast<float>(r) + sampleOffset.y);
                 normalizedCoordinates /= currentResolution;
-                
+            
                 glm::vec3 sampleColor;
                 // Construct ray, send it out into the scene and see what we hit.
 #if DOF_ON
                 /* Begin of the Depth of field */
                 int sampleTimes = 200;
                 for (int i = 0; i < sampleTimes; i++) {
-                    std::shared_ptr<Ray> randomRay = currentCamera->GenerateRandomRayFromLenArea(normalizedCoordinates);
-                    assert(randomRay);
+                    Ray randomRay;
+                    currentCamera->GenerateRandomRayFromLenArea(normalizedCoordinates, randomRay);
+                    intersectionArena.Reset();
                     IntersectionState rayIntersection(storedApplication->GetMaxReflectionBounces(), storedApplication->GetMaxRefractionBounces());
-                    bool didHitScene = currentScene->Trace(randomRay.get(), &rayIntersection);
+                    bool didHitScene = currentScene->Trace(&randomRay, &rayIntersection);
                     // Use the intersection data to compute the BRDF response.
                     if (didHitScene) {
-                        sampleColor += currentRenderer->ComputeSampleColor(rayIntersection, *randomRay.get());
+                        sampleColor += currentRenderer->ComputeSampleColor(rayIntersection, randomRay);
                     }
                 }
                 // take the average of the sampling colors
                 sampleColor = glm::vec3(sampleColor.x / sampleTimes, sampleColor.y / sampleTimes,sampleColor.z / sampleTimes);
                 /* End of DOF */  
 #else
-                std::shared_ptr<Ray> cameraRay = currentCamera->GenerateRayForNormalizedCoordinates(normalizedCoordinates);
-                assert(cameraRay);
+                Ray cameraRay;
+                currentCamera->GenerateRayForNormalizedCoordinates(normalizedCoordinates, cameraRay);
  
+                intersectionArena.Reset();
                 IntersectionState rayIntersection(storedApplication->GetMaxReflectionBounces(), storedApplication->GetMaxRefractionBounces());
-                bool didHitScene = currentScene->Trace(cameraRay.get(), &rayIntersection);
+                bool didHitScene = currentScene->Trace(&cameraRay, &rayIntersection);
 
                 // Use the intersection data to compute the BRDF response.                
                 if (didHitScene) {
-                    sampleColor = currentRenderer->ComputeSampleColor(rayIntersection, *cameraRay.get());
+                    sampleColor = currentRenderer->ComputeSampleColor(rayIntersection, cameraRay);
                 } 
 #endif             
                 return sampleColor;
-            }), c, r);
-        }
+            },
+            [&](int c, int r, glm::vec3 pixelColor) {
+                imageWriter.SetPixelColor(pixelColor, c, r);
+            });
     }
     std::cout<<"RayTracer.run::finish pixel-wise ray tracing."<<std::endl;
     
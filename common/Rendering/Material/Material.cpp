@@ -60,8 +60,9 @@ glm::vec3 Material::ComputeSpecular(const struct IntersectionState& intersection
 glm::vec3 Material::ComputeReflection(const class Renderer* renderer, const struct IntersectionState& intersection) const
 {
     glm::vec3 reflectedColor;
-    if (intersection.reflectionIntersection && intersection.reflectionIntersection->hasIntersection) {
-        reflectedColor = renderer->ComputeSampleColor(*intersection.reflectionIntersection.get(), intersection.reflectionIntersection->intersectionRay);
+    const IntersectionState* reflectionIntersection = renderer->TraceReflection(intersection);
+    if (reflectionIntersection && reflectionIntersection->hasIntersection) {
+        reflectedColor = reflectionIntersection->russianRouletteWeight * renderer->ComputeSampleColor(*reflectionIntersection, reflectionIntersection->intersectionRay);
     }
     return reflectedColor;
 }
@@ -69,8 +70,9 @@ glm::vec3 Material::ComputeReflection(const class Renderer* renderer, const stru
 glm::vec3 Material::ComputeTransmission(const class Renderer* renderer, const struct IntersectionState& intersection) const
 {
     glm::vec3 transmissionColor;
-    if (intersection.refractionIntersection && intersection.refractionIntersection->hasIntersection) {
-        transmissionColor = renderer->ComputeSampleColor(*intersection.refractionIntersection.get(), intersection.refractionIntersection->intersectionRay);
+    const IntersectionState* refractionIntersection = renderer->TraceRefraction(intersection);
+    if (refractionIntersection && refractionIntersection->hasIntersection) {
+        transmissionColor = refractionIntersection->russianRouletteWeight * renderer->ComputeSampleColor(*refractionIntersection, refractionIntersection->intersectionRay);
     }
     return transmissionColor;
 }
@@ -9,4 +9,19 @@ Renderer::Renderer(std::shared_ptr<Scene> scene, std::shared_ptr<ColorSampler> s
 
 Renderer::~Renderer()
 {
-}
\ No newline at end of file
+}
+
+bool Renderer::ComputeImage(const Application& application, const Camera& camera, const std::function<void(int, int, glm::vec3)>& pixelWriter)
+{
+    return false;
+}
+
+const IntersectionState* Renderer::TraceReflection(const IntersectionState& intersection) const
+{
+    return storedScene->TraceReflection(intersection);
+}
+
+const IntersectionState* Renderer::TraceRefraction(const IntersectionState& intersection) const
+{
+    return storedScene->TraceRefraction(intersection);
+}
@@ -11,6 +11,15 @@ public:
     virtual void InitializeRenderer() = 0;
     
     virtual glm::vec3 ComputeSampleColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay) const = 0;
+
+    // Renderers that need the whole image at once (e.g. progressive photon mapping) override this, write every pixel
+    // through pixelWriter(x, y, color) and return true. By default it returns false and RayTracer samples the image
+    // pixel by pixel through ComputeSampleColor.
+    virtual bool ComputeImage(const class Application& application, const class Camera& camera, const std::function<void(int, int, glm::vec3)>& pixelWriter);
+
+    // Materials go through these to get the secondary hits they need; see Scene::TraceReflection.
+    const struct IntersectionState* TraceReflection(const struct IntersectionState& intersection) const;
+    const struct IntersectionState* TraceRefraction(const struct IntersectionState& intersection) const;
 protected:
     std::shared_ptr<class Scene> storedScene;
     std::shared_ptr<class ColorSampler> storedSampler;
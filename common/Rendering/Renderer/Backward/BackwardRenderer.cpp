@@ -6,14 +6,31 @@
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Rendering/Material/Material.h"
 #include "common/Intersection/IntersectionState.h"
+#include "common/Scene/Lights/Sampling/LightBVH.h"
+#include "common/Utility/Random/Random.h"
 
 BackwardRenderer::BackwardRenderer(std::shared_ptr<Scene> scene, std::shared_ptr<ColorSampler> sampler) :
-    Renderer(scene, sampler)
+    Renderer(scene, sampler), lightsPerShadingPoint(0)
+{
+}
+
+BackwardRenderer::~BackwardRenderer()
 {
 }
 
 void BackwardRenderer::InitializeRenderer()
 {
+    lightBVH.reset();
+    if (lightsPerShadingPoint > 0) {
+        lightBVH = make_unique<LightBVH>();
+        lightBVH->Build(*storedScene.get());
+    }
+}
+
+void BackwardRenderer::SetLightSampling(int inputLightsPerShadingPoint)
+{
+    assert(inputLightsPerShadingPoint >= 0);
+    lightsPerShadingPoint = inputLightsPerShadingPoint;
 }
 
 glm::vec3 BackwardRenderer::ComputeSampleColor(const IntersectionState& intersection, const Ray& fromCameraRay) const
@@ -22,7 +39,7 @@ glm::vec3 BackwardRenderer::ComputeSampleColor(const IntersectionState& intersec
         return glm::vec3();
     }
 
-    glm::vec3 intersectionPoint = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
+    glm::vec3 intersectionPoint = intersection.ComputePosition();
     const MeshObject* parentObject = intersection.intersectedPrimitive->GetParentMeshObject();
     assert(parentObject);
 
@@ -31,61 +48,55 @@ glm::vec3 BackwardRenderer::ComputeSampleColor(const IntersectionState& intersec
 
     // Compute the color at the intersection.
     glm::vec3 sampleColor;
-    for (size_t i = 0; i < storedScene->GetTotalLights(); ++i) {
-        const Light* light = storedScene->GetLightObject(i);
-        assert(light);
-
-        // Sample light using rays, Number of samples and where to sample is determined by the light.
-        std::vector<Ray> sampleRays;
-        light->ComputeSampleRays(sampleRays, intersectionPoint, intersection.ComputeNormal());
+    if (!lightBVH) {
+        for (size_t i = 0; i < storedScene->GetTotalLights(); ++i) {
+            const Light* light = storedScene->GetLightObject(i);
+            assert(light);
+            sampleColor += ComputeLightContribution(light, intersection, intersectionPoint, fromCameraRay, objectMaterial);
+        }
+    } else {
+        const std::vector<const Light*>& unboundedLights = lightBVH->GetUnboundedLights();
+        for (size_t i = 0; i < unboundedLights.size(); ++i) {
+            sampleColor += ComputeLightContribution(unboundedLights[i], intersection, intersectionPoint, fromCameraRay, objectMaterial);
+        }
 
-        for (size_t s = 0; s < sampleRays.size(); ++s) {
-            // note that max T should be set to be right before the light.
-            IntersectionState state(0,0);
-            bool didIntersect;
-            bool hit = false;
-            glm::vec3 color = light->GetLightColor();
-            float bounces=10;
-            do {
-                bounces--;               
-                didIntersect=storedScene->Trace(&sampleRays[s], &state);
-                if (!didIntersect) {
-                    break;
-                }
-                
-                else {
-                    const MeshObject* hitMesh = state.intersectedPrimitive->GetParentMeshObject();
-                    assert(hitMesh);
-                    const Material* hitMaterial = hitMesh->GetMaterial();
-                    assert(hitMaterial);
-                    
-                    if (!hitMaterial->IsTransmissive()) {
-                        hit=true;
-                        break;
-                    }
-                    else {
-                        const glm::vec3 hitPoint = state.intersectionRay.GetRayPosition(state.intersectionT);
-                        sampleRays[s].SetRayPosition(hitPoint+LARGE_EPSILON*sampleRays[s].GetRayDirection());
-                        sampleRays[s].SetMaxT(sampleRays[s].GetMaxT()-state.intersectionT);
-                        
-                        glm::vec3 dt=hitMaterial->GetBaseTransmittance();
-                        color.x *= std::sqrt(dt.x);
-                        color.y *= std::sqrt(dt.y);
-                        color.z *= std::sqrt(dt.z);
-                    }
-                }
-            } while(bounces>0);
-            
-            if (hit) {
-                continue;
+        // Every pick is an unbiased estimate of the sum over all bounded lights; their average is used.
+        const glm::vec3 normal = intersection.ComputeNormal();
+        Random::Generator& generator = Random::GetThreadGenerator();
+        for (int i = 0; i < lightsPerShadingPoint; ++i) {
+            float lightPdf;
+            const Light* light = lightBVH->SampleLight(intersectionPoint, normal, generator.NextFloat(), lightPdf);
+            if (light) {
+                sampleColor += ComputeLightContribution(light, intersection, intersectionPoint, fromCameraRay, objectMaterial) / (lightPdf * static_cast<float>(lightsPerShadingPoint));
             }
-            
-            const float lightAttenuation = light->ComputeLightAttenuation(intersectionPoint);
-            // Note that the material should compute the parts of the lighting equation too.
-            const glm::vec3 brdfResponse = objectMaterial->ComputeBRDF(intersection,color, sampleRays[s], fromCameraRay, lightAttenuation);
-            sampleColor += brdfResponse;
         }
     }
     sampleColor += objectMaterial->ComputeNonLightDependentBRDF(this, intersection);
     return sampleColor;
 }
+
+glm::vec3 BackwardRenderer::ComputeLightContribution(const Light* light, const IntersectionState& intersection, const glm::vec3& intersectionPoint, const Ray& fromCameraRay, const Material* objectMaterial) const
+{
+    // Nothing here shades recursively, so one buffer per thread serves every shading point.
+    static thread_local std::vector<Ray> sampleRays;
+    sampleRays.clear();
+
+    glm::vec3 lightContribution;
+    // Sample light using rays, Number of samples and where to sample is determined by the light.
+    light->ComputeSampleRays(sampleRays, intersectionPoint, intersection.ComputeNormal());
+
+    for (size_t s = 0; s < sampleRays.size(); ++s) {
+        // note that max T should be set to be right before the light.
+        const glm::vec3 transmittance = storedScene->ComputeShadowTransmittance(&sampleRays[s]);
+        if (transmittance == glm::vec3(0.f)) {
+            continue;
+        }
+        const glm::vec3 color = light->GetLightColor() * transmittance;
+
+        const float lightAttenuation = light->ComputeLightAttenuation(intersectionPoint);
+        // Note that the material should compute the parts of the lighting equation too.
+        const glm::vec3 brdfResponse = objectMaterial->ComputeBRDF(intersection,color, sampleRays[s], fromCameraRay, lightAttenuation);
+        lightContribution += brdfResponse;
+    }
+    return lightContribution;
+}
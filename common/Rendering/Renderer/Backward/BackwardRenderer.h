@@ -6,6 +6,18 @@ class BackwardRenderer : public Renderer
 {
 public:
     BackwardRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler);
+    virtual ~BackwardRenderer();
     virtual void InitializeRenderer() override;
     glm::vec3 ComputeSampleColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay) const override;
+
+    // With lightsPerShadingPoint > 0 every shading point picks that many lights (with replacement) through a LightBVH
+    // instead of shading with all of them, which keeps scenes with many lights affordable at the price of some noise.
+    // Directional lights are always shaded. Takes effect on InitializeRenderer.
+    void SetLightSampling(int lightsPerShadingPoint);
+private:
+    glm::vec3 ComputeLightContribution(const class Light* light, const struct IntersectionState& intersection, const glm::vec3& intersectionPoint,
+        const class Ray& fromCameraRay, const class Material* objectMaterial) const;
+
+    int lightsPerShadingPoint;
+    std::unique_ptr<class LightBVH> lightBVH;
 };
\ No newline at end of file
@@ -1 +1,14 @@
-#include "common/Rendering/Renderer/Photon/Photon.h"
\ No newline at end of file
+#include "common/Rendering/Renderer/Photon/Photon.h"
+
+Photon::Photon() :
+    encodedIntensity(0), encodedToLightDirection(0), encodedNormal(0)
+{
+}
+
+Photon::Photon(const glm::vec3& inputPosition, const glm::vec3& intensity, const glm::vec3& toLightDirection, const glm::vec3& normal) :
+    position(inputPosition),
+    encodedIntensity(Compression::EncodeRGBE(intensity)),
+    encodedToLightDirection(Compression::EncodeOctahedral16(toLightDirection)),
+    encodedNormal(Compression::EncodeOctahedral16(normal))
+{
+}
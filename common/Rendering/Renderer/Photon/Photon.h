@@ -1,21 +1,36 @@
 #pragma once
 
 #include "common/common.h"
-#include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Utility/Compression/Compression.h"
 
+// A stored photon takes 20 bytes so that maps of tens of millions of photons fit in memory: the position stays exact
+// for the kd-tree, the power is kept in shared-exponent RGB and both directions in 16-bit octahedral form. Gathering
+// decodes the fields it needs on the fly.
 struct Photon
 {
-    typedef float value_type;
+    Photon();
+    Photon(const glm::vec3& inputPosition, const glm::vec3& intensity, const glm::vec3& toLightDirection, const glm::vec3& normal);
+
+    glm::vec3 GetIntensity() const
+    {
+        return Compression::DecodeRGBE(encodedIntensity);
+    }
+
+    // Unit vector from the photon back towards where it came from.
+    glm::vec3 GetToLightDirection() const
+    {
+        return Compression::DecodeOctahedral16(encodedToLightDirection);
+    }
+
+    glm::vec3 GetNormal() const
+    {
+        return Compression::DecodeOctahedral16(encodedNormal);
+    }
+
     glm::vec3 position;
-    glm::vec3 intensity;
-    glm::vec3 normal;
-    Ray toLightRay;
-    
-    inline value_type operator[](size_t const N) const { return position[static_cast<int>(N)]; }
+    uint32_t encodedIntensity;
+    uint16_t encodedToLightDirection;
+    uint16_t encodedNormal;
 };
 
-struct PhotonAccessor
-{
-    typedef float result_type;
-    float operator()(const Photon& t, size_t k) const { return t[k]; }
-};
+static_assert(sizeof(Photon) == 20, "Photons are meant to be stored in 20 bytes.");
@@ -0,0 +1,484 @@
+#include "common/Rendering/Renderer/Photon/PhotonMap.h"
+#include "common/Utility/Threading/ParallelFor.h"
+#include "common/Utility/Hash/Hash.h"
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+
+// Ranges with fewer photons than this are not split into further parallel tasks.
+const size_t PARALLEL_BUILD_GRAIN = 4096;
+
+// Photons per task of the grid build. The chunks only depend on the photon count, so neither does the order of the
+// photons within a bucket.
+const size_t GRID_BUILD_GRAIN = 16384;
+
+// The grid's photons are sorted by bucket this many bits at a time.
+const int RADIX_BITS = 8;
+const size_t RADIX_DIGITS = static_cast<size_t>(1) << RADIX_BITS;
+
+// Moves the median of the range along its widest axis into the middle, with the smaller photons before it and the
+// larger ones after it.
+void PartitionRange(const std::vector<Photon>& photons, std::vector<uint32_t>& order, std::vector<uint8_t>& splitAxes, size_t begin, size_t end)
+{
+    const size_t middle = begin + (end - begin) / 2;
+    if (end - begin < 2) {
+        splitAxes[middle] = 0;
+        return;
+    }
+
+    glm::vec3 minimum = photons[order[begin]].position;
+    glm::vec3 maximum = minimum;
+    for (size_t i = begin + 1; i < end; ++i) {
+        minimum = glm::min(minimum, photons[order[i]].position);
+        maximum = glm::max(maximum, photons[order[i]].position);
+    }
+    const glm::vec3 extent = maximum - minimum;
+    const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, [&](uint32_t first, uint32_t second) {
+        return photons[first].position[axis] < photons[second].position[axis];
+    });
+    splitAxes[middle] = static_cast<uint8_t>(axis);
+}
+
+void BuildRange(const std::vector<Photon>& photons, std::vector<uint32_t>& order, std::vector<uint8_t>& splitAxes, size_t begin, size_t end)
+{
+    if (begin >= end) {
+        return;
+    }
+    PartitionRange(photons, order, splitAxes, begin, end);
+    const size_t middle = begin + (end - begin) / 2;
+    BuildRange(photons, order, splitAxes, begin, middle);
+    BuildRange(photons, order, splitAxes, middle + 1, end);
+}
+
+// A range still to be searched, the squared distance to the split plane it lies behind and, for nearest searches, the
+// photon on that split.
+struct TraversalEntry
+{
+    size_t begin;
+    size_t end;
+    float squaredDistance;
+    size_t node;
+};
+
+bool IsCloser(const PhotonMap::NearbyPhoton& first, const PhotonMap::NearbyPhoton& second)
+{
+    return first.squaredDistance < second.squaredDistance;
+}
+
+// Adds a photon within the current radius to a nearest search that keeps the k closest photons and shrinks the radius
+// to the furthest of them once it has k.
+void AddNearest(PhotonMap::NearbyPhoton* nearest, size_t k, size_t& totalFound, float& squaredRadius, const Photon* photon, float squaredDistance)
+{
+    // Collect unordered until the buffer is full; only then does the furthest photon need to be tracked.
+    if (totalFound < k) {
+        nearest[totalFound++] = { photon, squaredDistance };
+        if (totalFound == k) {
+            std::make_heap(nearest, nearest + totalFound, IsCloser);
+            squaredRadius = nearest[0].squaredDistance;
+        }
+    } else {
+        std::pop_heap(nearest, nearest + totalFound, IsCloser);
+        nearest[totalFound - 1] = { photon, squaredDistance };
+        std::push_heap(nearest, nearest + totalFound, IsCloser);
+        squaredRadius = nearest[0].squaredDistance;
+    }
+}
+
+// Moves photons[order[i]] to index i for every i, one permutation cycle at a time, so that the photons are never held
+// twice. Leaves 'order' as the identity.
+void ApplyOrder(std::vector<Photon>& photons, std::vector<uint32_t>& order)
+{
+    for (size_t i = 0; i < photons.size(); ++i) {
+        if (order[i] == i) {
+            continue;
+        }
+        const Photon cycleStart = photons[i];
+        size_t current = i;
+        while (order[current] != i) {
+            const size_t next = order[current];
+            photons[current] = photons[next];
+            order[current] = static_cast<uint32_t>(current);
+            current = next;
+        }
+        photons[current] = cycleStart;
+        order[current] = static_cast<uint32_t>(current);
+    }
+}
+
+glm::ivec3 ComputeCell(const glm::vec3& position, float inverseCellSize)
+{
+    return glm::ivec3(glm::floor(position * inverseCellSize));
+}
+
+}
+
+PhotonMap::PhotonMap() :
+    structure(PhotonMapStructure::KD_TREE), cellSize(0.f), photonData(nullptr), splitAxisData(nullptr), totalPhotons(0)
+{
+}
+
+void PhotonMap::SetStructure(PhotonMapStructure inputStructure, float inputCellSize)
+{
+    assert(inputStructure != PhotonMapStructure::HASHED_GRID || inputCellSize > 0.f);
+    structure = inputStructure;
+    cellSize = inputCellSize;
+}
+
+void PhotonMap::Build(std::vector<Photon>& inputPhotons)
+{
+    Clear();
+    assert(inputPhotons.size() <= std::numeric_limits<uint32_t>::max());
+    if (structure == PhotonMapStructure::HASHED_GRID) {
+        BuildGrid(inputPhotons);
+    } else {
+        BuildTree(inputPhotons);
+    }
+    photons.swap(inputPhotons);
+    photonData = photons.data();
+    totalPhotons = photons.size();
+}
+
+void PhotonMap::BuildTree(std::vector<Photon>& inputPhotons)
+{
+    const size_t totalInputPhotons = inputPhotons.size();
+
+    std::vector<uint32_t> order(totalInputPhotons);
+    std::iota(order.begin(), order.end(), 0);
+    splitAxes.resize(totalInputPhotons);
+
+    // Partition the top of the tree level by level, each level's ranges in parallel, until there are enough subtrees to
+    // keep every thread busy; then every subtree is finished as one task. The result does not depend on the number of
+    // threads.
+    const size_t targetSubtrees = 4 * static_cast<size_t>(Threading::GetTotalThreads());
+    std::vector<std::pair<size_t, size_t>> ranges(1, std::make_pair(static_cast<size_t>(0), totalInputPhotons));
+    while (ranges.size() < targetSubtrees) {
+        std::vector<std::pair<size_t, size_t>> childRanges;
+        std::vector<size_t> splitRanges;
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            if (ranges[i].second - ranges[i].first >= PARALLEL_BUILD_GRAIN) {
+                splitRanges.push_back(i);
+            } else {
+                childRanges.push_back(ranges[i]);
+            }
+        }
+        if (splitRanges.empty()) {
+            break;
+        }
+
+        Threading::ParallelFor(0, splitRanges.size(), 1, [&](size_t chunkBegin, size_t chunkEnd) {
+            for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+                const std::pair<size_t, size_t>& range = ranges[splitRanges[i]];
+                PartitionRange(inputPhotons, order, splitAxes, range.first, range.second);
+            }
+        });
+
+        for (size_t i = 0; i < splitRanges.size(); ++i) {
+            const std::pair<size_t, size_t>& range = ranges[splitRanges[i]];
+            const size_t middle = range.first + (range.second - range.first) / 2;
+            childRanges.push_back(std::make_pair(range.first, middle));
+            childRanges.push_back(std::make_pair(middle + 1, range.second));
+        }
+        ranges.swap(childRanges);
+    }
+
+    Threading::ParallelFor(0, ranges.size(), 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+            BuildRange(inputPhotons, order, splitAxes, ranges[i].first, ranges[i].second);
+        }
+    });
+
+    ApplyOrder(inputPhotons, order);
+    splitAxisData = splitAxes.data();
+}
+
+void PhotonMap::BuildGrid(std::vector<Photon>& inputPhotons)
+{
+    const size_t totalInputPhotons = inputPhotons.size();
+    const size_t totalChunks = (totalInputPhotons + GRID_BUILD_GRAIN - 1) / GRID_BUILD_GRAIN;
+
+    // At least as many buckets as photons keeps the cells a query looks at from sharing buckets with other cells.
+    size_t tableSize = 1;
+    int tableBits = 0;
+    while (tableSize < totalInputPhotons) {
+        tableSize <<= 1;
+        ++tableBits;
+    }
+    cellStarts.assign(tableSize + 1, 0);
+
+    const float inverseCellSize = 1.f / cellSize;
+    std::vector<uint32_t> buckets(totalInputPhotons);
+    std::vector<uint32_t> order(totalInputPhotons);
+    Threading::ParallelFor(0, totalInputPhotons, GRID_BUILD_GRAIN, [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+            buckets[i] = ComputeBucket(ComputeCell(inputPhotons[i].position, inverseCellSize));
+            order[i] = static_cast<uint32_t>(i);
+        }
+    });
+
+    // Stable least significant digit radix sort of the photons by bucket: every pass counts the digits per chunk in
+    // parallel, turns the counts into the chunks' output offsets and scatters the chunks in parallel.
+    {
+        std::vector<uint32_t> sortedBuckets(totalInputPhotons);
+        std::vector<uint32_t> sortedOrder(totalInputPhotons);
+        std::vector<uint32_t> digitOffsets(totalChunks * RADIX_DIGITS);
+        for (int shift = 0; shift < tableBits; shift += RADIX_BITS) {
+            std::fill(digitOffsets.begin(), digitOffsets.end(), 0);
+            Threading::ParallelFor(0, totalInputPhotons, GRID_BUILD_GRAIN, [&](size_t chunkBegin, size_t chunkEnd) {
+                uint32_t* chunkCounts = &digitOffsets[(chunkBegin / GRID_BUILD_GRAIN) * RADIX_DIGITS];
+                for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+                    ++chunkCounts[(buckets[i] >> shift) & (RADIX_DIGITS - 1)];
+                }
+            });
+
+            uint32_t offset = 0;
+            for (size_t digit = 0; digit < RADIX_DIGITS; ++digit) {
+                for (size_t chunk = 0; chunk < totalChunks; ++chunk) {
+                    const uint32_t count = digitOffsets[chunk * RADIX_DIGITS + digit];
+                    digitOffsets[chunk * RADIX_DIGITS + digit] = offset;
+                    offset += count;
+                }
+            }
+
+            Threading::ParallelFor(0, totalInputPhotons, GRID_BUILD_GRAIN, [&](size_t chunkBegin, size_t chunkEnd) {
+                uint32_t* chunkOffsets = &digitOffsets[(chunkBegin / GRID_BUILD_GRAIN) * RADIX_DIGITS];
+                for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+                    const uint32_t target = chunkOffsets[(buckets[i] >> shift) & (RADIX_DIGITS - 1)]++;
+                    sortedBuckets[target] = buckets[i];
+                    sortedOrder[target] = order[i];
+                }
+            });
+            buckets.swap(sortedBuckets);
+            order.swap(sortedOrder);
+        }
+    }
+
+    // The first photon of every bucket is where that bucket and the empty buckets right before it start.
+    Threading::ParallelFor(0, totalInputPhotons, GRID_BUILD_GRAIN, [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+            const size_t firstBucket = (i > 0) ? static_cast<size_t>(buckets[i - 1]) + 1 : 0;
+            for (size_t bucket = firstBucket; bucket <= buckets[i]; ++bucket) {
+                cellStarts[bucket] = static_cast<uint32_t>(i);
+            }
+        }
+    });
+    const size_t firstEmptyBucket = totalInputPhotons ? static_cast<size_t>(buckets.back()) + 1 : 0;
+    std::fill(cellStarts.begin() + firstEmptyBucket, cellStarts.end(), static_cast<uint32_t>(totalInputPhotons));
+
+    ApplyOrder(inputPhotons, order);
+    positionsX.resize(totalInputPhotons);
+    positionsY.resize(totalInputPhotons);
+    positionsZ.resize(totalInputPhotons);
+    Threading::ParallelFor(0, totalInputPhotons, GRID_BUILD_GRAIN, [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+            positionsX[i] = inputPhotons[i].position.x;
+            positionsY[i] = inputPhotons[i].position.y;
+            positionsZ[i] = inputPhotons[i].position.z;
+        }
+    });
+}
+
+uint32_t PhotonMap::ComputeBucket(const glm::ivec3& cell) const
+{
+    const uint64_t packedCell = (static_cast<uint64_t>(cell.x) & 0x1FFFFF) | ((static_cast<uint64_t>(cell.y) & 0x1FFFFF) << 21) |
+        ((static_cast<uint64_t>(cell.z) & 0x1FFFFF) << 42);
+    return static_cast<uint32_t>(Hash::MixBits(packedCell) & (cellStarts.size() - 2));
+}
+
+template<typename BucketVisitor>
+void PhotonMap::VisitBuckets(const glm::vec3& position, float radius, BucketVisitor&& visitor) const
+{
+    const float inverseCellSize = 1.f / cellSize;
+    const glm::ivec3 minCell = ComputeCell(position - radius, inverseCellSize);
+    const glm::ivec3 maxCell = ComputeCell(position + radius, inverseCellSize);
+    const glm::ivec3 totalCells = maxCell - minCell + 1;
+    if (static_cast<int64_t>(totalCells.x) * totalCells.y * totalCells.z > MAX_QUERY_CELLS) {
+        visitor(static_cast<size_t>(0), totalPhotons);
+        return;
+    }
+
+    // Neighbouring cells may share a bucket, which must still only be searched once.
+    uint32_t queryBuckets[MAX_QUERY_CELLS];
+    int totalBuckets = 0;
+    for (int z = minCell.z; z <= maxCell.z; ++z) {
+        for (int y = minCell.y; y <= maxCell.y; ++y) {
+            for (int x = minCell.x; x <= maxCell.x; ++x) {
+                queryBuckets[totalBuckets++] = ComputeBucket(glm::ivec3(x, y, z));
+            }
+        }
+    }
+    std::sort(queryBuckets, queryBuckets + totalBuckets);
+    for (int i = 0; i < totalBuckets; ++i) {
+        if (i == 0 || queryBuckets[i] != queryBuckets[i - 1]) {
+            visitor(static_cast<size_t>(cellStarts[queryBuckets[i]]), static_cast<size_t>(cellStarts[queryBuckets[i] + 1]));
+        }
+    }
+}
+
+void PhotonMap::ComputeSquaredDistances(const glm::vec3& position, size_t begin, size_t end, float* squaredDistances) const
+{
+    // Plain loop over the separate coordinate arrays, which the compiler turns into SIMD code.
+    const float* x = positionsX.data() + begin;
+    const float* y = positionsY.data() + begin;
+    const float* z = positionsZ.data() + begin;
+    const float positionX = position.x;
+    const float positionY = position.y;
+    const float positionZ = position.z;
+    const size_t count = end - begin;
+    for (size_t i = 0; i < count; ++i) {
+        const float dx = x[i] - positionX;
+        const float dy = y[i] - positionY;
+        const float dz = z[i] - positionZ;
+        squaredDistances[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+void PhotonMap::Clear()
+{
+    photons.clear();
+    splitAxes.clear();
+    cellStarts.clear();
+    positionsX.clear();
+    positionsY.clear();
+    positionsZ.clear();
+    photonData = nullptr;
+    splitAxisData = nullptr;
+    totalPhotons = 0;
+}
+
+void PhotonMap::Attach(const Photon* inputPhotons, const uint8_t* inputSplitAxes, size_t inputTotalPhotons)
+{
+    Clear();
+    photonData = inputPhotons;
+    splitAxisData = inputSplitAxes;
+    totalPhotons = inputTotalPhotons;
+}
+
+void PhotonMap::FindWithinRadius(const glm::vec3& position, float radius, std::vector<const Photon*>& found) const
+{
+    const float squaredRadius = radius * radius;
+    if (IsGrid()) {
+        float squaredDistances[DISTANCE_BLOCK_SIZE];
+        VisitBuckets(position, radius, [&](size_t begin, size_t end) {
+            for (size_t blockBegin = begin; blockBegin < end; blockBegin += DISTANCE_BLOCK_SIZE) {
+                const size_t blockEnd = std::min(blockBegin + DISTANCE_BLOCK_SIZE, end);
+                ComputeSquaredDistances(position, blockBegin, blockEnd, squaredDistances);
+                for (size_t i = blockBegin; i < blockEnd; ++i) {
+                    if (squaredDistances[i - blockBegin] <= squaredRadius) {
+                        found.push_back(&photonData[i]);
+                    }
+                }
+            }
+        });
+        return;
+    }
+
+    TraversalEntry stack[MAX_TREE_DEPTH];
+    int stackSize = 0;
+    stack[stackSize++] = { 0, totalPhotons, 0.f, 0 };
+
+    while (stackSize > 0) {
+        const TraversalEntry entry = stack[--stackSize];
+        size_t begin = entry.begin;
+        size_t end = entry.end;
+        while (begin < end) {
+            const size_t middle = begin + (end - begin) / 2;
+            const glm::vec3 offset = position - photonData[middle].position;
+            if (glm::dot(offset, offset) <= squaredRadius) {
+                found.push_back(&photonData[middle]);
+            }
+
+            // Continue on the side of the split the position is on and come back for the other side if the sphere
+            // reaches over the split.
+            const float planeDistance = offset[splitAxisData[middle]];
+            const float squaredPlaneDistance = planeDistance * planeDistance;
+            if (planeDistance < 0.f) {
+                if (squaredPlaneDistance <= squaredRadius) {
+                    stack[stackSize++] = { middle + 1, end, squaredPlaneDistance, middle };
+                }
+                end = middle;
+            } else {
+                if (squaredPlaneDistance <= squaredRadius) {
+                    stack[stackSize++] = { begin, middle, squaredPlaneDistance, middle };
+                }
+                begin = middle + 1;
+            }
+        }
+    }
+}
+
+size_t PhotonMap::FindNearest(const glm::vec3& position, size_t k, float maxRadius, NearbyPhoton* nearest) const
+{
+    if (k == 0) {
+        return 0;
+    }
+
+    // Shrinks to the distance of the k-th closest photon once k photons have been found.
+    float squaredRadius = maxRadius * maxRadius;
+    size_t totalFound = 0;
+
+    if (IsGrid()) {
+        float squaredDistances[DISTANCE_BLOCK_SIZE];
+        VisitBuckets(position, maxRadius, [&](size_t begin, size_t end) {
+            for (size_t blockBegin = begin; blockBegin < end; blockBegin += DISTANCE_BLOCK_SIZE) {
+                const size_t blockEnd = std::min(blockBegin + DISTANCE_BLOCK_SIZE, end);
+                ComputeSquaredDistances(position, blockBegin, blockEnd, squaredDistances);
+                for (size_t i = blockBegin; i < blockEnd; ++i) {
+                    if (squaredDistances[i - blockBegin] <= squaredRadius) {
+                        AddNearest(nearest, k, totalFound, squaredRadius, &photonData[i], squaredDistances[i - blockBegin]);
+                    }
+                }
+            }
+        });
+        return totalFound;
+    }
+
+    TraversalEntry stack[MAX_TREE_DEPTH];
+    int stackSize = 0;
+    size_t begin = 0;
+    size_t end = totalPhotons;
+    for (;;) {
+        // Walk down to a leaf on the side of every split the position is on. The split photons and the far sides are
+        // only visited on the way back, once the closest photons have shrunk the radius.
+        while (begin < end) {
+            const size_t middle = begin + (end - begin) / 2;
+            const int axis = splitAxisData[middle];
+            const float planeDistance = position[axis] - photonData[middle].position[axis];
+            if (planeDistance < 0.f) {
+                stack[stackSize++] = { middle + 1, end, planeDistance * planeDistance, middle };
+                end = middle;
+            } else {
+                stack[stackSize++] = { begin, middle, planeDistance * planeDistance, middle };
+                begin = middle + 1;
+            }
+        }
+
+        bool hasNextRange = false;
+        while (stackSize > 0 && !hasNextRange) {
+            const TraversalEntry entry = stack[--stackSize];
+            // The split photon lies on the plane, so it is no closer than the plane either.
+            if (entry.squaredDistance > squaredRadius) {
+                continue;
+            }
+
+            const glm::vec3 offset = position - photonData[entry.node].position;
+            const float squaredDistance = glm::dot(offset, offset);
+            if (squaredDistance <= squaredRadius) {
+                AddNearest(nearest, k, totalFound, squaredRadius, &photonData[entry.node], squaredDistance);
+            }
+
+            if (entry.squaredDistance <= squaredRadius) {
+                begin = entry.begin;
+                end = entry.end;
+                hasNextRange = true;
+            }
+        }
+        if (!hasNextRange) {
+            break;
+        }
+    }
+    return totalFound;
+}
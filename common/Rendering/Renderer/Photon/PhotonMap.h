@@ -0,0 +1,119 @@
+#pragma once
+
+#include "common/Rendering/Renderer/Photon/Photon.h"
+
+enum class PhotonMapStructure
+{
+    // Implicit kd-tree (see PhotonMap). Adapts to any photon density and query radius and costs one byte per photon.
+    KD_TREE,
+    // Uniform grid hashed into a flat table of photon ranges, with cells as large as the largest query radius: a query
+    // only looks at the few cells its sphere overlaps, and the grid builds in linear time. Costs about 16-20 bytes per
+    // photon and gets slow when the radius is much smaller than the cells or the photons are very unevenly spread.
+    HASHED_GRID
+};
+
+// Photon map stored as an implicit kd-tree in flat arrays. Every range of the arrays keeps its median (along the axis
+// of largest extent) in the middle and the two halves are the subtrees, so the tree is balanced and has no child
+// pointers: queries walk the photons themselves with index arithmetic, and apart from the photons the tree only costs
+// one byte per photon for the split axis. Queries never allocate; results go into buffers the caller owns and reuses.
+//
+// With PhotonMapStructure::HASHED_GRID the photons are instead sorted by the hash bucket of their grid cell, a table
+// holds where every bucket starts, and the positions are also kept as separate x, y and z arrays so the distance
+// tests over a bucket run over contiguous floats.
+class PhotonMap
+{
+public:
+    struct NearbyPhoton
+    {
+        const Photon* photon;
+        float squaredDistance;
+    };
+
+    PhotonMap();
+
+    // Chooses what the next Build creates. 'cellSize' is the edge of the HASHED_GRID cells and is best set to the
+    // largest radius the queries use.
+    void SetStructure(PhotonMapStructure inputStructure, float inputCellSize = 0.f);
+
+    // Takes over the photons (the vector is left empty) and builds the tree or grid over them.
+    void Build(std::vector<Photon>& inputPhotons);
+    void Clear();
+
+    // Uses a kd-tree built elsewhere (e.g. one inside a memory-mapped PhotonMapCache) in place, without copying it,
+    // whatever structure is set. The photons and split axes have to stay valid until the map is cleared or rebuilt.
+    void Attach(const Photon* inputPhotons, const uint8_t* inputSplitAxes, size_t inputTotalPhotons);
+
+    // Appends all photons within 'radius' of 'position' to 'found'.
+    void FindWithinRadius(const glm::vec3& position, float radius, std::vector<const Photon*>& found) const;
+
+    // Writes up to 'k' photons closest to 'position' and no further than 'maxRadius' into 'nearest', which must have
+    // room for k entries, and returns how many were found. When all k were found the entries form a max-heap on the
+    // distance, so nearest[0] is the furthest of them; otherwise they are in no particular order.
+    size_t FindNearest(const glm::vec3& position, size_t k, float maxRadius, NearbyPhoton* nearest) const;
+
+    bool IsGrid() const
+    {
+        return !cellStarts.empty();
+    }
+
+    size_t GetTotalPhotons() const
+    {
+        return totalPhotons;
+    }
+
+    const Photon& GetPhoton(size_t index) const
+    {
+        return photonData[index];
+    }
+
+    // The photons in tree order and the split axis of each, as Attach expects them. Only meaningful for kd-trees.
+    const Photon* GetPhotons() const
+    {
+        return photonData;
+    }
+
+    const uint8_t* GetSplitAxes() const
+    {
+        return splitAxisData;
+    }
+
+private:
+    PhotonMap(const PhotonMap&) = delete;
+    PhotonMap& operator=(const PhotonMap&) = delete;
+
+    void BuildTree(std::vector<Photon>& inputPhotons);
+    void BuildGrid(std::vector<Photon>& inputPhotons);
+    uint32_t ComputeBucket(const glm::ivec3& cell) const;
+
+    // Calls visitor(begin, end) once for every bucket holding photons of the cells a sphere around 'position' overlaps.
+    template<typename BucketVisitor>
+    void VisitBuckets(const glm::vec3& position, float radius, BucketVisitor&& visitor) const;
+
+    // Writes the squared distances of the photons in [begin, end), at most DISTANCE_BLOCK_SIZE of them, to 'position'.
+    void ComputeSquaredDistances(const glm::vec3& position, size_t begin, size_t end, float* squaredDistances) const;
+
+    // Deepest traversal stack a query needs: the tree is balanced, so this covers any photon count that fits in memory.
+    static const int MAX_TREE_DEPTH = 64;
+
+    // Grid queries whose sphere overlaps more cells than this scan every photon instead.
+    static const int MAX_QUERY_CELLS = 64;
+
+    static const size_t DISTANCE_BLOCK_SIZE = 64;
+
+    PhotonMapStructure structure;
+    float cellSize;
+
+    // Own the tree when it was built here; empty when it is attached.
+    std::vector<Photon> photons;
+    std::vector<uint8_t> splitAxes;
+
+    // Only filled for grids. Bucket b holds the photons [cellStarts[b], cellStarts[b + 1]).
+    std::vector<uint32_t> cellStarts;
+    std::vector<float> positionsX;
+    std::vector<float> positionsY;
+    std::vector<float> positionsZ;
+
+    const Photon* photonData;
+    const uint8_t* splitAxisData;
+    size_t totalPhotons;
+};
@@ -0,0 +1,123 @@
+#include "common/Rendering/Renderer/Photon/PhotonMapCache.h"
+#include "common/Utility/File/BinaryStream.h"
+#include <cstdio>
+
+namespace
+{
+
+const uint32_t PHOTON_MAP_CACHE_MAGIC = 0x4D505452; // "RTPM"
+
+struct PhotonMapCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t photonSize;
+    uint32_t reserved;
+    uint64_t photonMapKey;
+    uint64_t totalDiffusePhotons;
+    uint64_t totalCausticPhotons;
+};
+
+static_assert(sizeof(Photon) % 4 == 0, "Photons are mapped directly out of the cache, so they must not need padding.");
+
+bool ReadPhotonMap(BinaryReader& reader, size_t fileSize, uint64_t totalPhotons, const Photon*& photons, const uint8_t*& splitAxes)
+{
+    if (totalPhotons > fileSize / sizeof(Photon)) {
+        return false;
+    }
+    const size_t count = static_cast<size_t>(totalPhotons);
+    if (!reader.ReadArray(photons, count) || !reader.ReadArray(splitAxes, count)) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (splitAxes[i] > 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void WritePhotonMap(BinaryWriter& writer, const PhotonMap& photonMap)
+{
+    assert(!photonMap.IsGrid());
+    writer.Write(photonMap.GetPhotons(), sizeof(Photon) * photonMap.GetTotalPhotons());
+    writer.Write(photonMap.GetSplitAxes(), photonMap.GetTotalPhotons());
+}
+
+}
+
+const uint32_t PhotonMapCache::CURRENT_VERSION = 1;
+
+bool PhotonMapCache::Open(const std::string& cacheFilename, uint64_t photonMapKey, PhotonMap& diffuseMap, PhotonMap& causticMap)
+{
+    Close();
+    if (!mappedFile.Open(cacheFilename)) {
+        return false;
+    }
+
+    BinaryReader reader(mappedFile.GetData(), mappedFile.GetSize());
+    PhotonMapCacheHeader header;
+    if (!reader.Read(header) || header.magic != PHOTON_MAP_CACHE_MAGIC || header.version != CURRENT_VERSION ||
+        header.photonSize != sizeof(Photon) || header.photonMapKey != photonMapKey) {
+        Close();
+        return false;
+    }
+
+    const Photon* diffusePhotons = nullptr;
+    const uint8_t* diffuseSplitAxes = nullptr;
+    const Photon* causticPhotons = nullptr;
+    const uint8_t* causticSplitAxes = nullptr;
+    if (!ReadPhotonMap(reader, mappedFile.GetSize(), header.totalDiffusePhotons, diffusePhotons, diffuseSplitAxes) ||
+        !ReadPhotonMap(reader, mappedFile.GetSize(), header.totalCausticPhotons, causticPhotons, causticSplitAxes)) {
+        std::cerr << "WARNING: Photon map cache " << cacheFilename << " is malformed. Ignoring it." << std::endl;
+        Close();
+        return false;
+    }
+
+    diffuseMap.Attach(diffusePhotons, diffuseSplitAxes, static_cast<size_t>(header.totalDiffusePhotons));
+    causticMap.Attach(causticPhotons, causticSplitAxes, static_cast<size_t>(header.totalCausticPhotons));
+    return true;
+}
+
+void PhotonMapCache::Close()
+{
+    mappedFile.Close();
+}
+
+bool PhotonMapCache::Write(const std::string& cacheFilename, uint64_t photonMapKey, const PhotonMap& diffuseMap, const PhotonMap& causticMap)
+{
+    // Write to a temporary file first so a crash or a concurrent reader never sees a half-written cache.
+    const std::string temporaryFilename = MappedFile::GetTemporaryFilename(cacheFilename);
+    {
+        std::ofstream stream(temporaryFilename, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            return false;
+        }
+        BinaryWriter writer(stream);
+
+        PhotonMapCacheHeader header;
+        header.magic = PHOTON_MAP_CACHE_MAGIC;
+        header.version = CURRENT_VERSION;
+        header.photonSize = sizeof(Photon);
+        header.reserved = 0;
+        header.photonMapKey = photonMapKey;
+        header.totalDiffusePhotons = diffuseMap.GetTotalPhotons();
+        header.totalCausticPhotons = causticMap.GetTotalPhotons();
+        writer.Write(header);
+
+        WritePhotonMap(writer, diffuseMap);
+        WritePhotonMap(writer, causticMap);
+
+        if (!stream) {
+            stream.close();
+            std::remove(temporaryFilename.c_str());
+            return false;
+        }
+    }
+
+    if (!MappedFile::ReplaceFile(temporaryFilename, cacheFilename)) {
+        std::remove(temporaryFilename.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "common/Rendering/Renderer/Photon/PhotonMap.h"
+#include "common/Utility/File/MappedFile.h"
+
+// Versioned binary file holding the global and caustic photon maps of a scene, already in kd-tree order. The file is
+// memory-mapped when opened and the maps are attached to the photons inside the mapping, so the cache must stay open
+// for as long as the maps are in use. The key is chosen by the caller and has to change whenever anything the photons
+// depend on does (see PhotonMappingRenderer::ComputePhotonMapKey).
+class PhotonMapCache
+{
+public:
+    static const uint32_t CURRENT_VERSION;
+
+    // Returns false if the cache is missing, malformed, from another version or does not match the key; the maps are
+    // left untouched then.
+    bool Open(const std::string& cacheFilename, uint64_t photonMapKey, PhotonMap& diffuseMap, PhotonMap& causticMap);
+    void Close();
+
+    static bool Write(const std::string& cacheFilename, uint64_t photonMapKey, const PhotonMap& diffuseMap, const PhotonMap& causticMap);
+private:
+    MappedFile mappedFile;
+};
@@ -9,35 +9,92 @@
 #include "common/Scene/SceneObject.h"
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Rendering/Material/Material.h"
+#include "common/Utility/Random/Random.h"
+#include "common/Utility/Threading/ParallelFor.h"
+#include "common/Utility/Hash/Hash.h"
 #include "glm/gtx/component_wise.hpp"
 
 #define VISUALIZE_PHOTON_MAPPING 0
 
+namespace
+{
+
+// Precomputed irradiance points considered per shading point; the closest one on the same surface is used.
+const size_t IRRADIANCE_LOOKUP_CANDIDATES = 4;
+
+}
+
+const float PhotonMappingRenderer::PHOTON_ESTIMATE_SCALE = 0.2f;
+const float PhotonMappingRenderer::PHOTON_NORMAL_THRESHOLD = 0.5f;
+
 PhotonMappingRenderer::PhotonMappingRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler):
     BackwardRenderer(scene, sampler), 
     diffusePhotonNumber(100000),
     causticPhotonNumber(100000),
-    maxPhotonBounces(5)
+    maxPhotonBounces(5),
+    gatherPhotons(50),
+    maxGatherRadius(0.05f),
+    photonFilter(PhotonFilter::NONE),
+    photonMapStructure(PhotonMapStructure::KD_TREE),
+    photonLookup(PhotonLookup::DENSITY_ESTIMATE),
+    irradianceSpacing(4)
 {
-    srand(static_cast<unsigned int>(time(NULL)));
 }
 
 void PhotonMappingRenderer::InitializeRenderer()
 {
-    // Generate Photon Maps
-    diffuseTotal=0;
-    GenericPhotonMapGeneration(diffuseMap, diffusePhotonNumber,0);
-    diffuseMap.optimise();
-    std::cout<<"finish initialize Global photon map: "<<diffuseTotal<<"/"<<diffusePhotonNumber<<std::endl;
-
-    causticTotal=0;
-    GenericPhotonMapGeneration(causticMap, causticPhotonNumber,1);
-    causticMap.optimise();
-    std::cout<<"finish initialize Caustic photon map: "<<causticTotal<<"/"<<causticPhotonNumber<<std::endl;
+    BackwardRenderer::InitializeRenderer();
+
+    diffuseMap.Clear();
+    causticMap.Clear();
+    diffuseMap.SetStructure(photonMapStructure, maxGatherRadius);
+    causticMap.SetStructure(photonMapStructure, maxGatherRadius);
+    diffuseIrradianceMap.SetStructure(photonMapStructure, maxGatherRadius);
+    causticIrradianceMap.SetStructure(photonMapStructure, maxGatherRadius);
+
+    const bool usePhotonMapCache = !photonMapCacheFilename.empty() && photonMapStructure == PhotonMapStructure::KD_TREE;
+    const uint64_t photonMapKey = usePhotonMapCache ? ComputePhotonMapKey() : 0;
+    if (usePhotonMapCache && photonMapCache.Open(photonMapCacheFilename, photonMapKey, diffuseMap, causticMap)) {
+        diffuseTotal=static_cast<int>(diffuseMap.GetTotalPhotons());
+        causticTotal=static_cast<int>(causticMap.GetTotalPhotons());
+        std::cout<<"finish loading photon maps from "<<photonMapCacheFilename<<": "<<diffuseTotal<<" global, "<<causticTotal<<" caustic"<<std::endl;
+    } else {
+        photonMapCache.Close();
+
+        // Generate Photon Maps
+        GenericPhotonMapGeneration(diffuseMap, diffusePhotonNumber,0);
+        diffuseTotal=static_cast<int>(diffuseMap.GetTotalPhotons());
+        std::cout<<"finish initialize Global photon map: "<<diffuseTotal<<"/"<<diffusePhotonNumber<<std::endl;
+
+        GenericPhotonMapGeneration(causticMap, causticPhotonNumber,1);
+        causticTotal=static_cast<int>(causticMap.GetTotalPhotons());
+        std::cout<<"finish initialize Caustic photon map: "<<causticTotal<<"/"<<causticPhotonNumber<<std::endl;
+
+        if (usePhotonMapCache && !PhotonMapCache::Write(photonMapCacheFilename, photonMapKey, diffuseMap, causticMap)) {
+            std::cerr<<"WARNING: Could not write photon map cache "<<photonMapCacheFilename<<"."<<std::endl;
+        }
+    }
+
+    diffuseIrradianceMap.Clear();
+    causticIrradianceMap.Clear();
+    if (photonLookup == PhotonLookup::PRECOMPUTED_IRRADIANCE) {
+        PrecomputeIrradiance(diffuseMap, diffuseIrradianceMap);
+        PrecomputeIrradiance(causticMap, causticIrradianceMap);
+        std::cout<<"finish precomputing irradiance: "<<diffuseIrradianceMap.GetTotalPhotons()<<" global, "<<causticIrradianceMap.GetTotalPhotons()<<" caustic"<<std::endl;
+    }
     
 }
 
-void PhotonMappingRenderer::GenericPhotonMapGeneration(PhotonKdtree& photonMap, int totalPhotons, int type)
+uint64_t PhotonMappingRenderer::ComputePhotonMapKey() const
+{
+    // Photon generation is deterministic, so the scene, the lights and the settings below decide every photon.
+    uint64_t key = Hash::HashCombine(storedScene->ComputeGeometryHash(), storedScene->ComputeLightHash());
+    key = Hash::HashCombine(key, static_cast<uint64_t>(diffusePhotonNumber));
+    key = Hash::HashCombine(key, static_cast<uint64_t>(causticPhotonNumber));
+    return Hash::HashCombine(key, static_cast<uint64_t>(maxPhotonBounces));
+}
+
+void PhotonMappingRenderer::GenericPhotonMapGeneration(PhotonMap& photonMap, int totalPhotons, int type, uint64_t photonPass)
 {
     float totalLightIntensity = 0.f;
     size_t totalLights = storedScene->GetTotalLights();
@@ -50,6 +107,7 @@ void PhotonMappingRenderer::GenericPhotonMapGeneration(PhotonKdtree& photonMap,
     }
 
     // Shoot photons -- number of photons for light is proportional to the light's intensity relative to the total light intensity of the scene.
+    std::vector<Photon> photons;
     for (size_t i = 0; i < totalLights; ++i) {
         const Light* currentLight = storedScene->GetLightObject(i);
         if (!currentLight) {
@@ -59,28 +117,45 @@ void PhotonMappingRenderer::GenericPhotonMapGeneration(PhotonKdtree& photonMap,
         const float proportion = glm::length(currentLight->GetLightColor()) / totalLightIntensity;
         const int totalPhotonsForLight = static_cast<const int>(proportion * totalPhotons);
         const glm::vec3 photonIntensity = currentLight->GetLightColor() / static_cast<float>(totalPhotonsForLight);
-        for (int j = 0; j < totalPhotonsForLight; ++j) {
-            Ray photonRay;
+        const uint64_t photonKey = Random::MakeKey(Random::MakeKey(static_cast<uint64_t>(type), photonPass), static_cast<uint64_t>(i));
+
+        // Every worker stores into the buffer of its chunk; the buffers are appended in chunk order afterwards.
+        std::vector<std::vector<Photon>> chunkPhotons((totalPhotonsForLight + PHOTON_GRAIN_SIZE - 1) / PHOTON_GRAIN_SIZE);
+        Threading::ParallelFor(0, totalPhotonsForLight, PHOTON_GRAIN_SIZE, [&](size_t chunkBegin, size_t chunkEnd) {
+            std::vector<Photon>& chunkBuffer = chunkPhotons[chunkBegin / PHOTON_GRAIN_SIZE];
             std::vector<char> path;
-            path.push_back('L');
-            currentLight->GenerateRandomPhotonRay(photonRay);
-            switch (type) {
-                case 0:
-                    if (!TraceGlobalPhoton(photonMap, &photonRay, photonIntensity, path, 1.f, maxPhotonBounces)) {
-                        j--;
+            for (size_t j = chunkBegin; j < chunkEnd; ++j) {
+                // Every photon has its own stream and every attempt (including the ones that are thrown away and
+                // retried) gets its own sample of it, so a photon does not depend on which thread shoots it.
+                const uint64_t photonStream = Random::MakeKey(photonKey, static_cast<uint64_t>(j));
+                bool stored = false;
+                for (uint64_t photonAttempt = 0; !stored; ++photonAttempt) {
+                    Random::GetThreadGenerator().Reset(photonStream, photonAttempt);
+                    Ray photonRay;
+                    path.clear();
+                    path.push_back('L');
+                    currentLight->GenerateRandomPhotonRay(photonRay);
+                    switch (type) {
+                        case 0:
+                            stored = TraceGlobalPhoton(chunkBuffer, &photonRay, photonIntensity, path, 1.f, maxPhotonBounces);
+                            break;
+                        case 1:
+                            stored = TraceCausticPhoton(chunkBuffer, &photonRay, photonIntensity, path, 1.f, maxPhotonBounces);
+                            break;
                     }
-                    break;
-                case 1:
-                    if(!TraceCausticPhoton(photonMap,&photonRay, photonIntensity, path, 1.f, maxPhotonBounces)) {
-                        j--;
-                    }
-                    break;
+                }
             }
+        });
+
+        for (size_t chunk = 0; chunk < chunkPhotons.size(); ++chunk) {
+            photons.insert(photons.end(), chunkPhotons[chunk].begin(), chunkPhotons[chunk].end());
         }
     }
+
+    photonMap.Build(photons);
 }
 
-bool PhotonMappingRenderer::TraceGlobalPhoton(PhotonKdtree& photonMap, Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces)
+bool PhotonMappingRenderer::TraceGlobalPhoton(std::vector<Photon>& photons, Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces) const
 {
     /*
      * Assignment 7 TODO: Trace a photon into the scene and make it bounce.
@@ -88,7 +163,7 @@ bool PhotonMappingRenderer::TraceGlobalPhoton(PhotonKdtree& photonMap, Ray* phot
      *    How to insert a 'Photon' struct into the photon map.
      *        Photon myPhoton;
      *        ... set photon properties ...
-     *        photonMap.insert(myPhoton);
+     *        photons.push_back(myPhoton);
      */
     assert(photonRay);
     IntersectionState state(0, 0);
@@ -101,8 +176,7 @@ bool PhotonMappingRenderer::TraceGlobalPhoton(PhotonKdtree& photonMap, Ray* phot
             const glm::vec3 intersectionPoint=state.intersectionRay.GetRayPosition(state.intersectionT);
             
             if (path.size()>1) {// store photon
-                StorePhoton(photonMap,intersectionPoint,lightIntensity,photonRay,state.ComputeNormal());
-                diffuseTotal++;
+                StorePhoton(photons,intersectionPoint,lightIntensity,photonRay,state.ComputeNormal());
                 flag=true;
             }
     
@@ -113,11 +187,12 @@ bool PhotonMappingRenderer::TraceGlobalPhoton(PhotonKdtree& photonMap, Ray* phot
 
             float pr=std::max(d.x,d.y);
             pr=std::max(pr,d.z);
-            float r=std::rand()*1.f/RAND_MAX;
+            Random::Generator& generator=Random::GetThreadGenerator();
+            float r=generator.NextFloat();
             if (r<pr) {// scatter photon
                 // hemisphere sampling
-                float u1=std::rand()*1.f/RAND_MAX;
-                float u2=std::rand()*1.f/RAND_MAX;
+                float u1=generator.NextFloat();
+                float u2=generator.NextFloat();
                 float r=std::sqrt(u1);
                 float theta=2*PI*u2;
                 float x=r*std::cos(theta);
@@ -144,7 +219,7 @@ bool PhotonMappingRenderer::TraceGlobalPhoton(PhotonKdtree& photonMap, Ray* phot
                 lightIntensity.x *= d.x/pr;
                 lightIntensity.y *= d.y/pr;
                 lightIntensity.z *= d.z/pr;
-                flag=flag || PhotonMappingRenderer::TraceGlobalPhoton(photonMap, photonRay, lightIntensity, path, currentIOR, remainingBounces-1);
+                flag=flag || PhotonMappingRenderer::TraceGlobalPhoton(photons, photonRay, lightIntensity, path, currentIOR, remainingBounces-1);
             }
         }
     }
@@ -154,7 +229,7 @@ bool PhotonMappingRenderer::TraceGlobalPhoton(PhotonKdtree& photonMap, Ray* phot
     return flag;    
 }
 
-bool PhotonMappingRenderer::TraceCausticPhoton(PhotonKdtree& photonMap, Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces)
+bool PhotonMappingRenderer::TraceCausticPhoton(std::vector<Photon>& photons, Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces) const
 {
     assert(photonRay);
     IntersectionState state(0, 0);
@@ -178,8 +253,7 @@ bool PhotonMappingRenderer::TraceCausticPhoton(PhotonKdtree& photonMap, Ray* pho
         const glm::vec3 normal=state.ComputeNormal();
         // hit diffusive object after specular object: add photon to map
         if (path.size()>1 && hitMaterial->HasDiffuseReflection()) {// store photon
-            StorePhoton(photonMap,intersectionPoint,lightIntensity,photonRay,normal);
-            causticTotal++;
+            StorePhoton(photons,intersectionPoint,lightIntensity,photonRay,normal);
         }
         
         if (remainingBounces>=1) {
@@ -192,7 +266,7 @@ bool PhotonMappingRenderer::TraceCausticPhoton(PhotonKdtree& photonMap, Ray* pho
                 PerformRayRefraction(refractionRay, *photonRay,intersectionPoint,NdR,state,targetIOR);
                 glm::vec3 dt=hitMaterial->GetBaseTransmittance();
                 const glm::vec3 refractionIntensity(dt.x*lightIntensity.x,dt.y*lightIntensity.y,dt.z*lightIntensity.z);                
-                TraceCausticPhoton(photonMap, &refractionRay, refractionIntensity, path, targetIOR, remainingBounces-1);
+                TraceCausticPhoton(photons, &refractionRay, refractionIntensity, path, targetIOR, remainingBounces-1);
             }
         }
         return true;
@@ -202,57 +276,155 @@ bool PhotonMappingRenderer::TraceCausticPhoton(PhotonKdtree& photonMap, Ray* pho
 glm::vec3 PhotonMappingRenderer::ComputeSampleColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay) const
 {
     glm::vec3 finalRenderColor = BackwardRenderer::ComputeSampleColor(intersection, fromCameraRay);
+    if (photonLookup == PhotonLookup::PRECOMPUTED_IRRADIANCE) {
+        finalRenderColor += LookupIrradiance(diffuseIrradianceMap, intersection, fromCameraRay);
+        finalRenderColor += LookupIrradiance(causticIrradianceMap, intersection, fromCameraRay);
+    } else {
+        finalRenderColor += EstimateRadiance(diffuseMap, intersection, fromCameraRay);
+        finalRenderColor += EstimateRadiance(causticMap, intersection, fromCameraRay);
+    }
+    return finalRenderColor;
+}
+
+size_t PhotonMappingRenderer::GatherPhotons(const PhotonMap& photonMap, const glm::vec3& position, PhotonMap::NearbyPhoton* nearestPhotons, float& squaredRadius) const
+{
+    // The k nearest photons adapt the gather radius to the local density: dense regions use a small disc and stay
+    // sharp, sparse ones grow it up to the maximum instead of finding nothing, and the work per shading point is bounded.
+    const size_t totalFound = photonMap.FindNearest(position, static_cast<size_t>(gatherPhotons), maxGatherRadius, nearestPhotons);
+
+    // With a full gather the disc ends at the furthest photon found; otherwise the photons only cover part of the
+    // maximum disc and dividing by it keeps sparse regions from being overestimated.
+    squaredRadius = (totalFound == static_cast<size_t>(gatherPhotons)) ? nearestPhotons[0].squaredDistance : maxGatherRadius * maxGatherRadius;
+    return (squaredRadius > 0.f) ? totalFound : 0;
+}
+
+float PhotonMappingRenderer::ComputeFilterWeight(float squaredDistance, float squaredRadius) const
+{
+    switch (photonFilter) {
+        case PhotonFilter::CONE:
+            return 1.f - std::sqrt(squaredDistance / squaredRadius);
+        case PhotonFilter::EPANECHNIKOV:
+            return 1.f - squaredDistance / squaredRadius;
+        default:
+            return 1.f;
+    }
+}
 
-    Photon intersectionVirtualPhoton;
-    intersectionVirtualPhoton.position = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
+float PhotonMappingRenderer::ComputeFilterNormalization() const
+{
+    // Integral of the filter over the unit disc relative to a flat one, so every filter preserves the total energy.
+    switch (photonFilter) {
+        case PhotonFilter::CONE:
+            return 1.f / 3.f;
+        case PhotonFilter::EPANECHNIKOV:
+            return 0.5f;
+        default:
+            return 1.f;
+    }
+}
 
-    std::vector<Photon> foundPhotons;
-    float sampleRadius=0.03f;
-    diffuseMap.find_within_range(intersectionVirtualPhoton, sampleRadius, std::back_inserter(foundPhotons));    
-    causticMap.find_within_range(intersectionVirtualPhoton, sampleRadius, std::back_inserter(foundPhotons));
+glm::vec3 PhotonMappingRenderer::EstimateRadiance(const PhotonMap& photonMap, const struct IntersectionState& intersection, const class Ray& fromCameraRay) const
+{
+    PhotonMap::NearbyPhoton nearestPhotons[MAX_GATHER_PHOTONS];
+    float squaredRadius;
+    const size_t totalFound = GatherPhotons(photonMap, intersection.ComputePosition(), nearestPhotons, squaredRadius);
+    if (!totalFound) {
+        return glm::vec3();
+    }
 
-    if (!foundPhotons.empty()) {
 #if VISUALIZE_PHOTON_MAPPING
-        finalRenderColor += glm::vec3(1.f, 0.f, 0.f);
+    return glm::vec3(1.f, 0.f, 0.f);
 #else
-        Photon samplePhoton;
-        glm::vec3 sampleColor;
-        glm::vec3 intersectNormal=intersection.ComputeNormal();
-        
-        const MeshObject* parentObject = intersection.intersectedPrimitive->GetParentMeshObject();
-        assert(parentObject);
-        const Material* objectMaterial = parentObject->GetMaterial();
-        assert(objectMaterial);            
-        
-        IntersectionState sampleIntersection(0,0);
-        size_t used=0;
-        for (size_t s=0; s<foundPhotons.size(); s++) {
-            samplePhoton=foundPhotons[s];
-            if (glm::dot(intersectNormal,samplePhoton.normal)>0.5) {//filtering by normal
-                const glm::vec3 brdfResponse = objectMaterial->ComputeBRDF(intersection, samplePhoton.intensity, samplePhoton.toLightRay, fromCameraRay, 1.f);
-                sampleColor += brdfResponse;
-                used++;
-            }
-            //else { std::cout << glm::dot(intersectNormal,samplePhoton.normal) << std::endl;}
+    const MeshObject* parentObject = intersection.intersectedPrimitive->GetParentMeshObject();
+    assert(parentObject);
+    const Material* objectMaterial = parentObject->GetMaterial();
+    assert(objectMaterial);
+
+    const glm::vec3 intersectNormal = intersection.ComputeNormal();
+    // Photons only store their direction; one ray is pointed along each of them in turn for the BRDF.
+    Ray toLightRay;
+    glm::vec3 sampleColor;
+    for (size_t s = 0; s < totalFound; ++s) {
+        const Photon& samplePhoton = *nearestPhotons[s].photon;
+        if (glm::dot(intersectNormal, samplePhoton.GetNormal()) <= PHOTON_NORMAL_THRESHOLD) {
+            continue;
         }
-        sampleColor /= (5*(used+1)*PI*sampleRadius*sampleRadius/(foundPhotons.size()+1)); 
-        //if (used<foundPhotons.size()) { std::cout << used << ", "<<foundPhotons.size() << std::endl;}
-        //std::cout << "s: "<<sampleColor.x << ", " << sampleColor.y << ", " << sampleColor.z << std::endl;
-        //std::cout << "f: "<<finalRenderColor.x << ", " << finalRenderColor.y << ", " << finalRenderColor.z << std::endl;
-        finalRenderColor += sampleColor;
+
+        const float weight = ComputeFilterWeight(nearestPhotons[s].squaredDistance, squaredRadius);
+        toLightRay.SetRayPosition(samplePhoton.position);
+        toLightRay.SetRayDirection(samplePhoton.GetToLightDirection());
+        sampleColor += weight * objectMaterial->ComputeBRDF(intersection, samplePhoton.GetIntensity(), toLightRay, fromCameraRay, 1.f);
+    }
+    return sampleColor * (PHOTON_ESTIMATE_SCALE / (ComputeFilterNormalization() * PI * squaredRadius));
 #endif
+}
+
+void PhotonMappingRenderer::PrecomputeIrradiance(const PhotonMap& photonMap, PhotonMap& irradianceMap) const
+{
+    // The map is in kd-tree order, which spreads every n-th photon evenly over the surfaces.
+    const size_t spacing = static_cast<size_t>(std::max(irradianceSpacing, 1));
+    std::vector<Photon> irradiancePhotons((photonMap.GetTotalPhotons() + spacing - 1) / spacing);
+    Threading::ParallelFor(0, irradiancePhotons.size(), PHOTON_GRAIN_SIZE, [&](size_t chunkBegin, size_t chunkEnd) {
+        PhotonMap::NearbyPhoton nearestPhotons[MAX_GATHER_PHOTONS];
+        for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+            const Photon& centerPhoton = photonMap.GetPhoton(i * spacing);
+            const glm::vec3 normal = centerPhoton.GetNormal();
+
+            // Same estimate as EstimateRadiance with the photon's own normal and only the cosine term of the response.
+            glm::vec3 irradiance;
+            float squaredRadius;
+            const size_t totalFound = GatherPhotons(photonMap, centerPhoton.position, nearestPhotons, squaredRadius);
+            for (size_t s = 0; s < totalFound; ++s) {
+                const Photon& samplePhoton = *nearestPhotons[s].photon;
+                if (glm::dot(normal, samplePhoton.GetNormal()) <= PHOTON_NORMAL_THRESHOLD) {
+                    continue;
+                }
+                const float NdL = std::max(glm::dot(normal, samplePhoton.GetToLightDirection()), 0.f);
+                irradiance += ComputeFilterWeight(nearestPhotons[s].squaredDistance, squaredRadius) * NdL * samplePhoton.GetIntensity();
+            }
+            if (totalFound) {
+                irradiance *= PHOTON_ESTIMATE_SCALE / (ComputeFilterNormalization() * PI * squaredRadius);
+            }
+            irradiancePhotons[i] = Photon(centerPhoton.position, irradiance, normal, normal);
+        }
+    });
+    irradianceMap.Build(irradiancePhotons);
+}
+
+glm::vec3 PhotonMappingRenderer::LookupIrradiance(const PhotonMap& irradianceMap, const struct IntersectionState& intersection, const class Ray& fromCameraRay) const
+{
+    PhotonMap::NearbyPhoton nearestPoints[IRRADIANCE_LOOKUP_CANDIDATES];
+    const size_t totalFound = irradianceMap.FindNearest(intersection.ComputePosition(), IRRADIANCE_LOOKUP_CANDIDATES, maxGatherRadius, nearestPoints);
+
+    const glm::vec3 intersectNormal = intersection.ComputeNormal();
+    const Photon* closestPoint = nullptr;
+    float closestSquaredDistance = std::numeric_limits<float>::max();
+    for (size_t s = 0; s < totalFound; ++s) {
+        if (nearestPoints[s].squaredDistance < closestSquaredDistance && glm::dot(intersectNormal, nearestPoints[s].photon->GetNormal()) > PHOTON_NORMAL_THRESHOLD) {
+            closestPoint = nearestPoints[s].photon;
+            closestSquaredDistance = nearestPoints[s].squaredDistance;
+        }
     }
-    return finalRenderColor;
+    if (!closestPoint) {
+        return glm::vec3();
+    }
+
+#if VISUALIZE_PHOTON_MAPPING
+    return glm::vec3(1.f, 0.f, 0.f);
+#else
+    const MeshObject* parentObject = intersection.intersectedPrimitive->GetParentMeshObject();
+    assert(parentObject);
+    const Material* objectMaterial = parentObject->GetMaterial();
+    assert(objectMaterial);
+
+    // Light arriving along the normal makes the diffuse response exactly the reflectance times the irradiance.
+    const Ray toLightRay(intersection.ComputePosition(), intersectNormal);
+    return objectMaterial->ComputeBRDF(intersection, closestPoint->GetIntensity(), toLightRay, fromCameraRay, 1.f, true, false);
+#endif
 }
 
-void PhotonMappingRenderer::StorePhoton(PhotonKdtree& photonMap, glm::vec3 intersectionPoint, glm::vec3 intensity, Ray* photonRay, glm::vec3 normal) {
-    Photon newPhoton;
-    newPhoton.position=intersectionPoint;
-    newPhoton.intensity=intensity;
-    const Ray toLightRay=Ray(intersectionPoint,-photonRay->GetRayDirection());
-    newPhoton.toLightRay=toLightRay;
-    newPhoton.normal=normal;
-    photonMap.insert(newPhoton);
+void PhotonMappingRenderer::StorePhoton(std::vector<Photon>& photons, glm::vec3 intersectionPoint, glm::vec3 intensity, Ray* photonRay, glm::vec3 normal) const {
+    photons.push_back(Photon(intersectionPoint, intensity, -photonRay->GetRayDirection(), normal));
 }
 
 void PhotonMappingRenderer::PerformRaySpecularReflection(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state) const
@@ -280,3 +452,30 @@ void PhotonMappingRenderer::SetNumberOfCausticPhotons(int caustic)
 {
     causticPhotonNumber = caustic;
 }
+
+void PhotonMappingRenderer::SetPhotonGathering(int photonsPerEstimate, float maxRadius)
+{
+    gatherPhotons = std::max(1, std::min(photonsPerEstimate, MAX_GATHER_PHOTONS));
+    maxGatherRadius = maxRadius;
+}
+
+void PhotonMappingRenderer::SetPhotonFilter(PhotonFilter filter)
+{
+    photonFilter = filter;
+}
+
+void PhotonMappingRenderer::SetPhotonLookup(PhotonLookup lookup, int inputIrradianceSpacing)
+{
+    photonLookup = lookup;
+    irradianceSpacing = std::max(inputIrradianceSpacing, 1);
+}
+
+void PhotonMappingRenderer::SetPhotonMapStructure(PhotonMapStructure structure)
+{
+    photonMapStructure = structure;
+}
+
+void PhotonMappingRenderer::SetPhotonMapCache(const std::string& cacheFilename)
+{
+    photonMapCacheFilename = cacheFilename;
+}
@@ -1,12 +1,32 @@
 #pragma once
 
 #include "common/Rendering/Renderer.h"
-#include "common/Rendering/Renderer/Photon/Photon.h"
-#include <kdtree++/kdtree.hpp>
+#include "common/Rendering/Renderer/Photon/PhotonMap.h"
+#include "common/Rendering/Renderer/Photon/PhotonMapCache.h"
 #include <functional>
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Rendering/Renderer/Backward/BackwardRenderer.h"
 
+enum class PhotonFilter
+{
+    // Every gathered photon counts the same.
+    NONE,
+    // Weight falls off linearly to zero at the gather radius (Jensen's cone filter); keeps caustic edges sharper.
+    CONE,
+    // Weight 1 - d^2 / r^2; the smoothest falloff and the lowest variance of the three.
+    EPANECHNIKOV
+};
+
+enum class PhotonLookup
+{
+    // Density estimate over the nearest photons at every shading point.
+    DENSITY_ESTIMATE,
+    // Irradiance is estimated once at a subset of the photons after the maps are built (Christensen, "Faster Photon
+    // Map Global Illumination") and shading only looks up the nearest of those points. Much cheaper per shading point,
+    // but only the diffuse response to the photons is kept.
+    PRECOMPUTED_IRRADIANCE
+};
+
 class PhotonMappingRenderer : public BackwardRenderer
 {
 public:
@@ -16,10 +36,33 @@ public:
 
     void SetNumberOfDiffusePhotons(int diffuse);
     void SetNumberOfCausticPhotons(int caustic);
-private:
-    using PhotonKdtree = KDTree::KDTree<3, Photon, PhotonAccessor>;
-    PhotonKdtree diffuseMap;
-    PhotonKdtree causticMap;
+
+    // Radiance is estimated from the 'photonsPerEstimate' photons nearest to the shading point (at most
+    // MAX_GATHER_PHOTONS) of each map, looking no further than 'maxRadius'.
+    void SetPhotonGathering(int photonsPerEstimate, float maxRadius);
+    void SetPhotonFilter(PhotonFilter filter);
+
+    // With PRECOMPUTED_IRRADIANCE, irradiance is estimated at every 'irradianceSpacing'-th photon of each map.
+    void SetPhotonLookup(PhotonLookup lookup, int irradianceSpacing = 4);
+
+    // The photon maps are loaded from this file if it was written for the same scene, lights and photon counts, which
+    // skips the photon pass when only the camera or the post-processing changed; otherwise they are generated and
+    // written to it. Empty (the default) always generates them. The cache holds kd-trees and is not used with grids.
+    void SetPhotonMapCache(const std::string& cacheFilename);
+
+    // HASHED_GRID builds faster and answers fixed-radius gathers with less work than the default KD_TREE, at the price
+    // of more memory; its cells are as large as the gather radius.
+    void SetPhotonMapStructure(PhotonMapStructure structure);
+
+    static const int MAX_GATHER_PHOTONS = 256;
+protected:
+    // Brightness of the photon estimate relative to the direct lighting, as the renderer has always scaled it.
+    static const float PHOTON_ESTIMATE_SCALE;
+    // Photons whose surface normal deviates more than this (as a cosine) from the shading normal lie on another surface.
+    static const float PHOTON_NORMAL_THRESHOLD;
+
+    PhotonMap diffuseMap;
+    PhotonMap causticMap;
 
     int diffusePhotonNumber;
     int causticPhotonNumber;
@@ -27,10 +70,37 @@ private:
     int causticTotal;
     int maxPhotonBounces;
 
-    void GenericPhotonMapGeneration(PhotonKdtree& photonMap, int totalPhotons, int type);
-    bool TraceGlobalPhoton(PhotonKdtree& photonMap, Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces);    
-    bool TraceCausticPhoton(PhotonKdtree& photonMap, Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces);
-    void StorePhoton(PhotonKdtree& photonMap, glm::vec3 intersectionPoint, glm::vec3 intensity, Ray* photonRay, glm::vec3 normal);
+    int gatherPhotons;
+    float maxGatherRadius;
+    PhotonFilter photonFilter;
+    PhotonMapStructure photonMapStructure;
+
+    PhotonLookup photonLookup;
+    int irradianceSpacing;
+    // Photons of these maps hold irradiance instead of power; their direction is unused.
+    PhotonMap diffuseIrradianceMap;
+    PhotonMap causticIrradianceMap;
+
+    std::string photonMapCacheFilename;
+    // Holds the mapping diffuseMap and causticMap point into when they were loaded.
+    PhotonMapCache photonMapCache;
+
+    // Number of photon slots a worker shoots into one buffer. Chunks are fixed by the photon count alone, so the merged
+    // map is the same whatever the number of threads.
+    static const int PHOTON_GRAIN_SIZE = 1024;
+
+    uint64_t ComputePhotonMapKey() const;
+    size_t GatherPhotons(const PhotonMap& photonMap, const glm::vec3& position, PhotonMap::NearbyPhoton* nearestPhotons, float& squaredRadius) const;
+    float ComputeFilterWeight(float squaredDistance, float squaredRadius) const;
+    float ComputeFilterNormalization() const;
+    glm::vec3 EstimateRadiance(const PhotonMap& photonMap, const struct IntersectionState& intersection, const class Ray& fromCameraRay) const;
+    void PrecomputeIrradiance(const PhotonMap& photonMap, PhotonMap& irradianceMap) const;
+    glm::vec3 LookupIrradiance(const PhotonMap& irradianceMap, const struct IntersectionState& intersection, const class Ray& fromCameraRay) const;
+    // Every photonPass shoots a different, independent set of photons.
+    void GenericPhotonMapGeneration(PhotonMap& photonMap, int totalPhotons, int type, uint64_t photonPass = 0);
+    bool TraceGlobalPhoton(std::vector<Photon>& photons, Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces) const;
+    bool TraceCausticPhoton(std::vector<Photon>& photons, Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces) const;
+    void StorePhoton(std::vector<Photon>& photons, glm::vec3 intersectionPoint, glm::vec3 intensity, Ray* photonRay, glm::vec3 normal) const;
     void PerformRaySpecularReflection(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state) const;
     void PerformRayRefraction(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state, float& targetIOR) const;
 };
@@ -0,0 +1,177 @@
+#include "common/Rendering/Renderer/Photon/ProgressivePhotonMappingRenderer.h"
+#include "common/Application.h"
+#include "common/Scene/Scene.h"
+#include "common/Scene/Camera/Camera.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Scene/Geometry/Primitives/Primitive.h"
+#include "common/Scene/Geometry/Mesh/MeshObject.h"
+#include "common/Rendering/Material/Material.h"
+#include "common/Intersection/IntersectionState.h"
+#include "common/Intersection/IntersectionStateArena.h"
+#include "common/Utility/Random/Random.h"
+#include "common/Utility/Threading/ParallelFor.h"
+#include <chrono>
+
+ProgressivePhotonMappingRenderer::ProgressivePhotonMappingRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler):
+    PhotonMappingRenderer(scene, sampler),
+    initialRadius(0.05f),
+    radiusReduction(0.7f),
+    maxPasses(16),
+    timeLimitSeconds(0.f)
+{
+}
+
+void ProgressivePhotonMappingRenderer::InitializeRenderer()
+{
+    // Photons are shot pass by pass in ComputeImage.
+    BackwardRenderer::InitializeRenderer();
+}
+
+glm::vec3 ProgressivePhotonMappingRenderer::ComputeSampleColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay) const
+{
+    // Photons only reach the visible points; secondary hits the materials trace are shaded without them.
+    return BackwardRenderer::ComputeSampleColor(intersection, fromCameraRay);
+}
+
+bool ProgressivePhotonMappingRenderer::ComputeImage(const Application& application, const Camera& camera, const std::function<void(int, int, glm::vec3)>& pixelWriter)
+{
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    const glm::vec2 resolution = application.GetImageOutputResolution();
+    const int width = static_cast<int>(resolution.x);
+    const int height = static_cast<int>(resolution.y);
+
+    VisiblePoint initialPoint;
+    initialPoint.radius = initialRadius;
+    initialPoint.totalPhotons = 0.f;
+    std::vector<VisiblePoint> visiblePoints(static_cast<size_t>(width) * height, initialPoint);
+
+    // Radii only shrink, so grid cells as large as the initial radius serve every pass.
+    passDiffuseMap.SetStructure(photonMapStructure, initialRadius);
+    passCausticMap.SetStructure(photonMapStructure, initialRadius);
+
+    int totalPasses = 0;
+    float elapsedSeconds = 0.f;
+    do {
+        const uint64_t pass = static_cast<uint64_t>(totalPasses);
+        TraceVisiblePoints(application, camera, pass, visiblePoints);
+
+        GenericPhotonMapGeneration(passDiffuseMap, diffusePhotonNumber, 0, pass);
+        GenericPhotonMapGeneration(passCausticMap, causticPhotonNumber, 1, pass);
+        GatherPassPhotons(visiblePoints);
+        passDiffuseMap.Clear();
+        passCausticMap.Clear();
+
+        ++totalPasses;
+        elapsedSeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - startTime).count();
+    } while (totalPasses < maxPasses && (timeLimitSeconds <= 0.f || elapsedSeconds < timeLimitSeconds));
+    std::cout<<"finish progressive photon mapping: "<<totalPasses<<" passes in "<<elapsedSeconds<<"s"<<std::endl;
+
+    for (int r = 0; r < height; ++r) {
+        for (int c = 0; c < width; ++c) {
+            const VisiblePoint& point = visiblePoints[static_cast<size_t>(r) * width + c];
+            const glm::vec3 photonRadiance = point.flux * (PHOTON_ESTIMATE_SCALE / (PI * point.radius * point.radius));
+            pixelWriter(c, r, (point.directRadiance + photonRadiance) / static_cast<float>(totalPasses));
+        }
+    }
+    return true;
+}
+
+void ProgressivePhotonMappingRenderer::TraceVisiblePoints(const Application& application, const Camera& camera, uint64_t pass, std::vector<VisiblePoint>& visiblePoints) const
+{
+    const glm::vec2 resolution = application.GetImageOutputResolution();
+    const int width = static_cast<int>(resolution.x);
+    const int maxReflectionBounces = application.GetMaxReflectionBounces();
+    const int maxRefractionBounces = application.GetMaxRefractionBounces();
+
+    Threading::ParallelFor(0, visiblePoints.size(), PIXEL_GRAIN_SIZE, [&](size_t chunkBegin, size_t chunkEnd) {
+        IntersectionStateArena& intersectionArena = IntersectionStateArena::GetThreadArena();
+        intersectionArena.Reserve(maxReflectionBounces, maxRefractionBounces);
+        for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+            VisiblePoint& point = visiblePoints[i];
+            const int c = static_cast<int>(i % width);
+            const int r = static_cast<int>(i / width);
+
+            // Every pass looks through a different spot of the pixel, which also antialiases the image.
+            Random::Generator& generator = Random::GetThreadGenerator();
+            generator.Reset(Random::PixelKey(c, r), pass);
+            glm::vec2 normalizedCoordinates(static_cast<float>(c) + generator.NextFloat() - 0.5f, static_cast<float>(r) + generator.NextFloat() - 0.5f);
+            normalizedCoordinates /= resolution;
+
+            Ray cameraRay;
+            camera.GenerateRayForNormalizedCoordinates(normalizedCoordinates, cameraRay);
+            intersectionArena.Reset();
+            IntersectionState rayIntersection(maxReflectionBounces, maxRefractionBounces);
+            point.reflectance = glm::vec3();
+            if (!storedScene->Trace(&cameraRay, &rayIntersection)) {
+                continue;
+            }
+            point.directRadiance += BackwardRenderer::ComputeSampleColor(rayIntersection, cameraRay);
+
+            const MeshObject* parentObject = rayIntersection.intersectedPrimitive->GetParentMeshObject();
+            assert(parentObject);
+            const Material* objectMaterial = parentObject->GetMaterial();
+            assert(objectMaterial);
+
+            point.position = rayIntersection.ComputePosition();
+            point.normal = rayIntersection.ComputeNormal();
+            const Ray toLightRay(point.position, point.normal);
+            point.reflectance = objectMaterial->ComputeBRDF(rayIntersection, glm::vec3(1.f), toLightRay, cameraRay, 1.f, true, false);
+        }
+    });
+}
+
+void ProgressivePhotonMappingRenderer::GatherPassPhotons(std::vector<VisiblePoint>& visiblePoints) const
+{
+    const PhotonMap* passMaps[] = { &passDiffuseMap, &passCausticMap };
+    Threading::ParallelFor(0, visiblePoints.size(), PIXEL_GRAIN_SIZE, [&](size_t chunkBegin, size_t chunkEnd) {
+        std::vector<const Photon*> foundPhotons;
+        for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+            VisiblePoint& point = visiblePoints[i];
+            if (point.reflectance == glm::vec3()) {
+                continue;
+            }
+
+            foundPhotons.clear();
+            for (const PhotonMap* passMap : passMaps) {
+                passMap->FindWithinRadius(point.position, point.radius, foundPhotons);
+            }
+
+            float newPhotons = 0.f;
+            glm::vec3 newFlux;
+            for (const Photon* photon : foundPhotons) {
+                if (glm::dot(point.normal, photon->GetNormal()) <= PHOTON_NORMAL_THRESHOLD) {
+                    continue;
+                }
+                newPhotons += 1.f;
+                newFlux += std::max(glm::dot(point.normal, photon->GetToLightDirection()), 0.f) * photon->GetIntensity();
+            }
+            if (newPhotons == 0.f) {
+                continue;
+            }
+
+            // Keep only a fraction of the new photons and shrink the disc so that the density it implies stays the
+            // same; the flux gathered so far is scaled down with the area.
+            const float keptPhotons = point.totalPhotons + radiusReduction * newPhotons;
+            const float areaRatio = keptPhotons / (point.totalPhotons + newPhotons);
+            point.radius *= std::sqrt(areaRatio);
+            point.totalPhotons = keptPhotons;
+            point.flux = (point.flux + point.reflectance * newFlux) * areaRatio;
+        }
+    });
+}
+
+void ProgressivePhotonMappingRenderer::SetInitialRadius(float radius)
+{
+    initialRadius = radius;
+}
+
+void ProgressivePhotonMappingRenderer::SetRadiusReduction(float alpha)
+{
+    radiusReduction = glm::clamp(alpha, 0.f, 1.f);
+}
+
+void ProgressivePhotonMappingRenderer::SetPassBudget(int inputMaxPasses, float inputTimeLimitSeconds)
+{
+    maxPasses = std::max(inputMaxPasses, 1);
+    timeLimitSeconds = inputTimeLimitSeconds;
+}
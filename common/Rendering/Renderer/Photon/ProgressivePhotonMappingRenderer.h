@@ -0,0 +1,62 @@
+#pragma once
+
+#include "common/Rendering/Renderer/Photon/PhotonMappingRenderer.h"
+
+// Stochastic progressive photon mapping (Hachisuka and Jensen). Instead of building one large photon map up front, the
+// image is refined in passes: a camera pass finds a visible point in every pixel, a photon pass shoots a fresh set of
+// photons into maps that are thrown away again once every pixel has gathered from them. Every pixel keeps a gather
+// radius that shrinks as photons arrive and the flux they brought, so the estimate converges without bias while memory
+// stays at one pass worth of photons plus a small record per pixel, however many passes are rendered.
+//
+// Photons per pass come from SetNumberOfDiffusePhotons and SetNumberOfCausticPhotons. Visible points are the first
+// hits of the camera rays and only take the diffuse response to the photons; reflections and refractions seen in them
+// are shaded like BackwardRenderer does.
+class ProgressivePhotonMappingRenderer : public PhotonMappingRenderer
+{
+public:
+    ProgressivePhotonMappingRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler);
+    virtual void InitializeRenderer() override;
+    glm::vec3 ComputeSampleColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay) const override;
+    virtual bool ComputeImage(const class Application& application, const class Camera& camera, const std::function<void(int, int, glm::vec3)>& pixelWriter) override;
+
+    // Gather radius every pixel starts out with.
+    void SetInitialRadius(float radius);
+
+    // Fraction of the photons found in a pass that is kept when the radius shrinks (alpha in the paper); smaller values
+    // shrink the radius faster and trade noise for bias.
+    void SetRadiusReduction(float alpha);
+
+    // Passes stop after 'maxPasses' or once 'timeLimitSeconds' have passed, whichever comes first; a time limit of 0
+    // means no limit. At least one pass is always rendered.
+    void SetPassBudget(int maxPasses, float timeLimitSeconds);
+
+private:
+    // What a pixel sees in the current pass and the photon statistics it keeps over all passes.
+    struct VisiblePoint
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        // Diffuse response to a unit of light arriving along the normal; zero when the pixel sees nothing photons can
+        // light.
+        glm::vec3 reflectance;
+        glm::vec3 directRadiance;
+        float radius;
+        float totalPhotons;
+        glm::vec3 flux;
+    };
+
+    void TraceVisiblePoints(const class Application& application, const class Camera& camera, uint64_t pass, std::vector<VisiblePoint>& visiblePoints) const;
+    void GatherPassPhotons(std::vector<VisiblePoint>& visiblePoints) const;
+
+    float initialRadius;
+    float radiusReduction;
+    int maxPasses;
+    float timeLimitSeconds;
+
+    // Only hold the photons of the pass in flight.
+    PhotonMap passDiffuseMap;
+    PhotonMap passCausticMap;
+
+    // Pixels a worker handles per chunk in the camera and gather passes.
+    static const int PIXEL_GRAIN_SIZE = 256;
+};
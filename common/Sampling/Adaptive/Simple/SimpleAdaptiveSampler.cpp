@@ -5,13 +5,23 @@ SimpleAdaptiveSampler::SimpleAdaptiveSampler() :
 {
 }
 
-std::unique_ptr<SamplerState> SimpleAdaptiveSampler::CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const
+std::unique_ptr<SamplerState> SimpleAdaptiveSampler::CreateSampler(const Random::Generator& generator, const int maxSamples, const int dimensions) const
 {
-    std::unique_ptr<SimpleAdaptiveSamplerState> state = make_unique<SimpleAdaptiveSamplerState>(randomDevice, maxSamples, dimensions);
-    state->internalState = internalSampler->CreateSampler(randomDevice, maxSamples, dimensions);
+    std::unique_ptr<SimpleAdaptiveSamplerState> state = make_unique<SimpleAdaptiveSamplerState>();
+    state->internalState = internalSampler->CreateSampler(generator, maxSamples, dimensions);
+    ResetSampler(*state.get(), generator, maxSamples, dimensions);
     return std::move(state);
 }
 
+void SimpleAdaptiveSampler::ResetSampler(SamplerState& state, const Random::Generator& generator, const int maxSamples, const int dimensions) const
+{
+    ColorSampler::ResetSampler(state, generator, maxSamples, dimensions);
+    SimpleAdaptiveSamplerState& adaptiveState = static_cast<SimpleAdaptiveSamplerState&>(state);
+    internalSampler->ResetSampler(*adaptiveState.internalState.get(), generator, maxSamples, dimensions);
+    // The internal sampler draws from our state, so it needs the generator it set up (e.g. with its sequence).
+    adaptiveState.generator = adaptiveState.internalState->generator;
+}
+
 glm::vec3 SimpleAdaptiveSampler::ComputeSampleCoordinate(SamplerState& state) const
 {
     return internalSampler->ComputeSampleCoordinate(state);
@@ -30,15 +40,11 @@ void SimpleAdaptiveSampler::SetInternalSampler(std::shared_ptr<ColorSampler> inp
 
 bool SimpleAdaptiveSampler::NotifyColorSampleForEarlyExit(SamplerState& state, glm::vec3 inColor) const
 {
-    if (static_cast<int>(state.colorHistory.size()) < minimumEarlyExitSamples) {
+    if (state.colorStatistics.totalSamples < minimumEarlyExitSamples) {
         return false;
     }
 
-    glm::vec3 averageColor;
-    for (size_t i = 0; i < state.colorHistory.size(); ++i) {
-        averageColor += state.colorHistory[i];
-    }
-    averageColor /= static_cast<float>(state.colorHistory.size());
+    const glm::vec3 averageColor = state.colorStatistics.mean;
 
     // ASSIGNMENT 5 (OPTIONAL): Modify this line to change the adaptive condition.
     if (glm::distance(averageColor, inColor) < earlyExitThreshold) {
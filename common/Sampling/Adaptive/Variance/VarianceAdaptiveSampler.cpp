@@ -0,0 +1,158 @@
+#include "common/Sampling/Adaptive/Variance/VarianceAdaptiveSampler.h"
+
+namespace
+{
+
+// Added to the brightness a pixel's error is measured against, so that nearly black pixels (whose relative error is
+// huge but invisible) do not soak up the budget.
+const float ERROR_BRIGHTNESS_OFFSET = 0.05f;
+
+struct TileError
+{
+    float error;
+    int tileIndex;
+
+    bool operator<(const TileError& other) const
+    {
+        return error > other.error;
+    }
+};
+
+}
+
+VarianceAdaptiveSampler::VarianceAdaptiveSampler() :
+    averageSamplesPerPixel(8.f), initialSamplesPerPixel(4), targetError(0.01f), timeLimit(0.f), tileSize(4)
+{
+}
+
+void VarianceAdaptiveSampler::SetInternalSampler(std::shared_ptr<ColorSampler> inputSampler)
+{
+    internalSampler = std::move(inputSampler);
+}
+
+void VarianceAdaptiveSampler::SetSampleBudget(float inputAverageSamples, int inputInitialSamples)
+{
+    assert(inputInitialSamples >= 2);
+    averageSamplesPerPixel = inputAverageSamples;
+    initialSamplesPerPixel = inputInitialSamples;
+}
+
+void VarianceAdaptiveSampler::SetStoppingCriteria(float inputTargetError, float timeLimitInSeconds)
+{
+    targetError = inputTargetError;
+    timeLimit = timeLimitInSeconds;
+}
+
+void VarianceAdaptiveSampler::SetTileSize(int inputTileSize)
+{
+    assert(inputTileSize > 0);
+    tileSize = inputTileSize;
+}
+
+std::unique_ptr<SamplerState> VarianceAdaptiveSampler::CreateSampler(const Random::Generator& generator, const int maxSamples, const int dimensions) const
+{
+    return internalSampler->CreateSampler(generator, maxSamples, dimensions);
+}
+
+void VarianceAdaptiveSampler::ResetSampler(SamplerState& state, const Random::Generator& generator, const int maxSamples, const int dimensions) const
+{
+    internalSampler->ResetSampler(state, generator, maxSamples, dimensions);
+}
+
+glm::vec3 VarianceAdaptiveSampler::ComputeSampleCoordinate(SamplerState& state) const
+{
+    return internalSampler->ComputeSampleCoordinate(state);
+}
+
+void VarianceAdaptiveSampler::InitializeSampler(class Application* app, class Scene* inputScene)
+{
+    ColorSampler::InitializeSampler(app, inputScene);
+    internalSampler->InitializeSampler(app, inputScene);
+}
+
+float VarianceAdaptiveSampler::ComputePixelError(const ColorStatistics& pixel) const
+{
+    if (pixel.totalSamples < 2) {
+        return std::numeric_limits<float>::max();
+    }
+    const glm::vec3 variance = pixel.GetVariance();
+    const float standardError = std::sqrt((variance.x + variance.y + variance.z) / (3.f * static_cast<float>(pixel.totalSamples)));
+    const float brightness = (pixel.mean.x + pixel.mean.y + pixel.mean.z) / 3.f;
+    return standardError / (brightness + ERROR_BRIGHTNESS_OFFSET);
+}
+
+bool VarianceAdaptiveSampler::PlanImagePass(const ImageSamplingProgress& progress, std::vector<int>& samplesToTake) const
+{
+    const int totalPixels = progress.width * progress.height;
+    samplesToTake.assign(totalPixels, 0);
+    if (progress.totalPasses == 0) {
+        std::fill(samplesToTake.begin(), samplesToTake.end(), std::min(initialSamplesPerPixel, progress.maxSamplesPerPixel));
+        return true;
+    }
+
+    if (timeLimit > 0.f && progress.elapsedSeconds >= timeLimit) {
+        DIAGNOSTICS_LOG("Adaptive sampling stopped by the time limit after " + std::to_string(progress.totalPasses) + " passes");
+        return false;
+    }
+
+    const int64_t totalBudget = static_cast<int64_t>(averageSamplesPerPixel * static_cast<float>(totalPixels));
+    int64_t remainingBudget = totalBudget - progress.totalSamples;
+    if (remainingBudget <= 0) {
+        return false;
+    }
+
+    const std::vector<ColorStatistics>& pixels = *progress.pixels;
+    const int tilesX = (progress.width + tileSize - 1) / tileSize;
+    const int tilesY = (progress.height + tileSize - 1) / tileSize;
+    std::vector<TileError> tileErrors;
+    tileErrors.reserve(static_cast<size_t>(tilesX) * tilesY);
+    for (int ty = 0; ty < tilesY; ++ty) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+            float errorSum = 0.f;
+            int totalTilePixels = 0;
+            bool canRefine = false;
+            for (int y = ty * tileSize; y < std::min((ty + 1) * tileSize, progress.height); ++y) {
+                for (int x = tx * tileSize; x < std::min((tx + 1) * tileSize, progress.width); ++x) {
+                    const ColorStatistics& pixel = pixels[static_cast<size_t>(y) * progress.width + x];
+                    errorSum += ComputePixelError(pixel);
+                    canRefine = canRefine || pixel.totalSamples < progress.maxSamplesPerPixel;
+                    ++totalTilePixels;
+                }
+            }
+
+            TileError tile;
+            tile.error = errorSum / static_cast<float>(totalTilePixels);
+            tile.tileIndex = ty * tilesX + tx;
+            if (canRefine && tile.error > targetError) {
+                tileErrors.push_back(tile);
+            }
+        }
+    }
+    std::sort(tileErrors.begin(), tileErrors.end());
+
+    // Worst tiles first: every pixel of the tile doubles its sample count, as far as the budget and the per-pixel
+    // limit allow.
+    int refinedTiles = 0;
+    for (size_t i = 0; i < tileErrors.size() && remainingBudget > 0; ++i) {
+        const int tx = tileErrors[i].tileIndex % tilesX;
+        const int ty = tileErrors[i].tileIndex / tilesX;
+        for (int y = ty * tileSize; y < std::min((ty + 1) * tileSize, progress.height) && remainingBudget > 0; ++y) {
+            for (int x = tx * tileSize; x < std::min((tx + 1) * tileSize, progress.width) && remainingBudget > 0; ++x) {
+                const size_t pixelIndex = static_cast<size_t>(y) * progress.width + x;
+                const int currentSamples = pixels[pixelIndex].totalSamples;
+                const int64_t newSamples = std::min(static_cast<int64_t>(std::min(currentSamples, progress.maxSamplesPerPixel - currentSamples)), remainingBudget);
+                samplesToTake[pixelIndex] = static_cast<int>(newSamples);
+                remainingBudget -= newSamples;
+            }
+        }
+        ++refinedTiles;
+    }
+
+    if (!refinedTiles) {
+        DIAGNOSTICS_LOG("Adaptive sampling reached the target error after " + std::to_string(progress.totalPasses) + " passes");
+        return false;
+    }
+    DIAGNOSTICS_LOG("Adaptive sampling pass " + std::to_string(progress.totalPasses) + ": refining " + std::to_string(refinedTiles) + " of " +
+        std::to_string(tileErrors.size()) + " tiles above the target error");
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "common/Sampling/ColorSampler.h"
+
+// Spreads a sample budget for the whole image over several passes. The first pass takes a few samples of every pixel;
+// every later pass estimates the relative error of each tile from the per-pixel variance (kept with Welford's
+// algorithm, see ColorStatistics) and doubles the samples of the worst tiles until the pass has used up what is left
+// of the budget. Rendering stops once the budget is spent, every tile is below the target error or the time limit is
+// reached. The sample positions come from the internal sampler.
+class VarianceAdaptiveSampler : public ColorSampler
+{
+public:
+    VarianceAdaptiveSampler();
+    void SetInternalSampler(std::shared_ptr<ColorSampler> inputSampler);
+
+    // The image gets averageSamplesPerPixel * (number of pixels) samples in total, at least initialSamplesPerPixel
+    // (two or more, the variance needs them) in every pixel and never more than the application's samples per pixel.
+    void SetSampleBudget(float averageSamplesPerPixel, int initialSamplesPerPixel);
+
+    // Tiles whose standard error relative to their brightness is below targetError are left alone. A time limit of 0
+    // means no limit; the pass that crosses it still finishes.
+    void SetStoppingCriteria(float targetError, float timeLimitInSeconds);
+
+    // Side length of the square pixel tiles the error is estimated and samples are assigned for. 1 works per pixel,
+    // which reacts faster to small features but trusts variance estimates from very few samples.
+    void SetTileSize(int inputTileSize);
+
+    virtual std::unique_ptr<SamplerState> CreateSampler(const Random::Generator& generator, const int maxSamples, const int dimensions) const override;
+    virtual void ResetSampler(SamplerState& state, const Random::Generator& generator, const int maxSamples, const int dimensions) const override;
+    virtual glm::vec3 ComputeSampleCoordinate(SamplerState& state) const override;
+
+    virtual void InitializeSampler(class Application* app, class Scene* inputScene) override;
+
+protected:
+    virtual bool PlanImagePass(const ImageSamplingProgress& progress, std::vector<int>& samplesToTake) const override;
+
+private:
+    float ComputePixelError(const ColorStatistics& pixel) const;
+
+    std::shared_ptr<ColorSampler> internalSampler;
+    float averageSamplesPerPixel;
+    int initialSamplesPerPixel;
+    float targetError;
+    float timeLimit;
+    int tileSize;
+};
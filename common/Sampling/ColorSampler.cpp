@@ -1,50 +1,113 @@
 #include "common/Sampling/ColorSampler.h"
+#include <atomic>
 
-ColorSampler::ColorSampler()
+namespace
 {
+
+std::atomic<uint64_t> nextSamplerId(1);
+
+struct ThreadSamplerState
+{
+    ThreadSamplerState() :
+        samplerId(0)
+    {
+    }
+
+    uint64_t samplerId;
+    std::unique_ptr<SamplerState> state;
+};
+
+// One entry per nesting level of ThreadSamplerStateScope on this thread; levels at or above 'depth' are free.
+struct ThreadSamplerStack
+{
+    ThreadSamplerStack() :
+        depth(0)
+    {
+    }
+
+    std::vector<ThreadSamplerState> levels;
+    size_t depth;
+};
+
+thread_local ThreadSamplerStack threadSamplerStack;
+
 }
 
-void ColorSampler::InitializeSampler(Application* app, Scene* inputScene)
+void ColorStatistics::AddSample(const glm::vec3& color)
 {
-    storedApp = app;
-    storedScene = inputScene;
+    ++totalSamples;
+    const glm::vec3 delta = color - mean;
+    mean += delta / static_cast<float>(totalSamples);
+    squaredDeviations += delta * (color - mean);
 }
 
-std::unique_ptr<SamplerState> ColorSampler::CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const
+void ColorStatistics::Reset()
 {
-    return std::move(make_unique<SamplerState>(randomDevice, maxSamples, dimensions));
+    mean = glm::vec3(0.f);
+    squaredDeviations = glm::vec3(0.f);
+    totalSamples = 0;
 }
 
-glm::vec3 ColorSampler::ComputeSamplesAndColor(const int maxSamples, const int dimensions, std::function<glm::vec3(glm::vec3)> colorComputer) const
+glm::vec3 ColorStatistics::GetVariance() const
 {
-    std::random_device randomDevice;
-    std::unique_ptr<SamplerState> newState = CreateSampler(randomDevice, maxSamples, dimensions);
+    if (totalSamples < 2) {
+        return glm::vec3(0.f);
+    }
+    return squaredDeviations / static_cast<float>(totalSamples - 1);
+}
 
-    glm::vec3 finalColor;
-    for (int i = 0; i < maxSamples; ++i) {
-        // Compute normalized sample. 
-        glm::vec3 sampleCoordinates = ComputeSampleCoordinate(*newState.get());
+ColorSampler::ColorSampler() :
+    samplerId(nextSamplerId++)
+{
+}
 
-        // Compute sample color.
-        glm::vec3 sampleColor = colorComputer(sampleCoordinates);
-        finalColor += sampleColor;
-        ++newState->samplesComputed;
+void ColorSampler::InitializeSampler(Application* app, Scene* inputScene)
+{
+    storedApp = app;
+    storedScene = inputScene;
+}
 
-        if (NotifyColorSampleForEarlyExit(*newState.get(), sampleColor)) {
-            break;
-        }
+std::unique_ptr<SamplerState> ColorSampler::CreateSampler(const Random::Generator& generator, const int maxSamples, const int dimensions) const
+{
+    std::unique_ptr<SamplerState> state = make_unique<SamplerState>();
+    ResetSampler(*state.get(), generator, maxSamples, dimensions);
+    return state;
+}
+
+void ColorSampler::ResetSampler(SamplerState& state, const Random::Generator& generator, const int maxSamples, const int dimensions) const
+{
+    state.generator = generator;
+    state.maxSamples = maxSamples;
+    state.dimensions = dimensions;
+    state.samplesComputed = 0;
+    state.colorStatistics.Reset();
+}
 
-        newState->colorHistory.push_back(sampleColor);
-        
+ColorSampler::ThreadSamplerStateScope::ThreadSamplerStateScope(const ColorSampler& sampler, const Random::Generator& generator, const int maxSamples, const int dimensions)
+{
+    if (threadSamplerStack.depth == threadSamplerStack.levels.size()) {
+        threadSamplerStack.levels.emplace_back();
+    }
+    ThreadSamplerState& level = threadSamplerStack.levels[threadSamplerStack.depth++];
+    if (level.samplerId != sampler.samplerId || !level.state) {
+        level.state = sampler.CreateSampler(generator, maxSamples, dimensions);
+        level.samplerId = sampler.samplerId;
+    } else {
+        sampler.ResetSampler(*level.state.get(), generator, maxSamples, dimensions);
     }
-    finalColor /= static_cast<float>(newState->samplesComputed);
-    return finalColor;
+    state = level.state.get();
+}
+
+ColorSampler::ThreadSamplerStateScope::~ThreadSamplerStateScope()
+{
+    assert(threadSamplerStack.depth > 0 && threadSamplerStack.levels[threadSamplerStack.depth - 1].state.get() == state);
+    --threadSamplerStack.depth;
 }
 
 glm::vec3 ColorSampler::ComputeSampleCoordinate(SamplerState& state) const
 {
     glm::vec3 sample;
-    for (int i = 0; i < 3; ++i) {
+    for (int i = 0; i < std::min(state.dimensions, 3); ++i) {
         sample[i] = GenerateRandomNumber(state);
     }
     return sample;
@@ -52,10 +115,15 @@ glm::vec3 ColorSampler::ComputeSampleCoordinate(SamplerState& state) const
 
 float ColorSampler::GenerateRandomNumber(SamplerState& state) const
 {
-    return static_cast<float>(state.dist(state.gen));
+    return state.generator.NextFloat();
 }
 
 bool ColorSampler::NotifyColorSampleForEarlyExit(SamplerState& state, glm::vec3 inColor) const
 {
     return false;
 }
+
+bool ColorSampler::PlanImagePass(const ImageSamplingProgress& progress, std::vector<int>& samplesToTake) const
+{
+    return false;
+}
@@ -1,22 +1,50 @@
 #pragma once
 
 #include "common/common.h"
-#include <random>
+#include "common/Utility/Random/Random.h"
+
+// Running mean and sum of squared deviations (Welford) of a set of sample colors. Samplers never need the individual
+// colors, so none are kept.
+struct ColorStatistics
+{
+    ColorStatistics()
+    {
+        Reset();
+    }
+
+    void AddSample(const glm::vec3& color);
+    void Reset();
+
+    // Unbiased sample variance; zero until there are two samples.
+    glm::vec3 GetVariance() const;
+
+    glm::vec3 mean;
+    glm::vec3 squaredDeviations;
+    int totalSamples;
+};
 
 struct SamplerState
 {
-    SamplerState(std::random_device& device, int inputMax, int inputDim) :
-        maxSamples(inputMax), dimensions(inputDim), samplesComputed(0), gen(device()), dist(0, 1)
+    SamplerState() :
+        maxSamples(0), dimensions(0), samplesComputed(0)
+    {
+    }
+
+    SamplerState(const Random::Generator& inputGenerator, int inputMax, int inputDim) :
+        maxSamples(inputMax), dimensions(inputDim), samplesComputed(0), generator(inputGenerator)
     {
     }
 
-    std::vector<glm::vec3> colorHistory;
-    const int maxSamples;
-    const int dimensions;
+    virtual ~SamplerState() {}
+
+    // Colors of the samples taken so far (not including one that made the sampler exit early).
+    ColorStatistics colorStatistics;
+
+    int maxSamples;
+    int dimensions;
     int samplesComputed;
 
-    std::mt19937 gen;
-    std::uniform_real_distribution<> dist;
+    Random::Generator generator;
 };
 
 class ColorSampler : public std::enable_shared_from_this<ColorSampler>
@@ -24,15 +52,180 @@ class ColorSampler : public std::enable_shared_from_this<ColorSampler>
 public:
     ColorSampler();
 
-    virtual std::unique_ptr<SamplerState> CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const;
+    virtual std::unique_ptr<SamplerState> CreateSampler(const Random::Generator& generator, const int maxSamples, const int dimensions) const;
+    // Reinitializes a state for another pixel without reallocating anything. The state must come from CreateSampler of
+    // this sampler (or be of the type it creates).
+    virtual void ResetSampler(SamplerState& state, const Random::Generator& generator, const int maxSamples, const int dimensions) const;
     virtual void InitializeSampler(class Application* app, class Scene* inputScene);
 
-    virtual glm::vec3 ComputeSamplesAndColor(const int maxSamples, const int dimensions, std::function<glm::vec3(glm::vec3)> colorComputer) const;
+    // Sample i draws its coordinate from the stream (randomKey, i). The thread's generator (see Random::GetThreadGenerator)
+    // continues that stream while colorComputer runs, so everything else the sample needs is reproducible too.
+    //
+    // colorComputer is any callable taking the sample coordinate and returning the sample color; it is called directly
+    // so it can be inlined. It may take samples of its own, from this sampler or any other.
+    template<typename ColorComputer>
+    glm::vec3 ComputeSamplesAndColor(const int maxSamples, const int dimensions, const uint64_t randomKey, ColorComputer&& colorComputer) const;
+
+    // Takes samples [firstSample, firstSample + totalSamples) of a pixel and adds their colors to pixelStatistics. The
+    // samples are the same ones ComputeSamplesAndColor would take at those indices, so a pixel can be refined over
+    // several passes. maxSamples is the most samples the pixel can end up with.
+    template<typename ColorComputer>
+    void AddSamples(ColorStatistics& pixelStatistics, const int firstSample, const int totalSamples, const int maxSamples, const int dimensions,
+        const uint64_t randomKey, ColorComputer&& colorComputer) const;
+
+    // Renders a whole image: colorComputer(x, y, sampleCoordinates) returns the color of one sample of pixel (x, y) and
+    // pixelWriter(x, y, color) receives the final color of every pixel. Plain samplers take maxSamplesPerPixel samples
+    // of every pixel in a single pass; image-adaptive samplers spread a sample budget over several passes (see
+    // PlanImagePass).
+    template<typename ColorComputer, typename PixelWriter>
+    void ComputeImage(const int width, const int height, const int maxSamplesPerPixel, const int dimensions, ColorComputer&& colorComputer,
+        PixelWriter&& pixelWriter) const;
+
     virtual glm::vec3 ComputeSampleCoordinate(SamplerState& state) const;
 protected:
     virtual float GenerateRandomNumber(SamplerState& state) const;
     virtual bool NotifyColorSampleForEarlyExit(SamplerState& state, glm::vec3 inColor) const;
 
+    struct ImageSamplingProgress
+    {
+        int width;
+        int height;
+        int maxSamplesPerPixel;
+        // Number of passes done so far; 0 when the first pass is being planned.
+        int totalPasses;
+        int64_t totalSamples;
+        float elapsedSeconds;
+        const std::vector<ColorStatistics>* pixels;
+    };
+
+    // Multi-pass hook for ComputeImage. Fills samplesToTake with the number of new samples for every pixel (row-major)
+    // and returns true, or returns false when the image is done. Returning false right away (the default) makes
+    // ComputeImage take maxSamplesPerPixel samples per pixel through ComputeSamplesAndColor instead.
+    virtual bool PlanImagePass(const ImageSamplingProgress& progress, std::vector<int>& samplesToTake) const;
+
+    // Lends out a sampler state of the calling thread for as long as it is in scope. States are kept per thread and per
+    // nesting level, so taking samples from inside colorComputer never resets the state of the samples around it; a
+    // level's state is created on first use and reset by ResetSampler while the same sampler keeps using it.
+    class ThreadSamplerStateScope
+    {
+    public:
+        ThreadSamplerStateScope(const ColorSampler& sampler, const Random::Generator& generator, const int maxSamples, const int dimensions);
+        ~ThreadSamplerStateScope();
+
+        SamplerState& GetState() const
+        {
+            return *state;
+        }
+    private:
+        ThreadSamplerStateScope(const ThreadSamplerStateScope&) = delete;
+        ThreadSamplerStateScope& operator=(const ThreadSamplerStateScope&) = delete;
+
+        SamplerState* state;
+    };
+
     class Application* storedApp;
     class Scene* storedScene;
-};
\ No newline at end of file
+
+private:
+    // Identifies the sampler in the per-thread state stack; unlike the address it is never reused.
+    const uint64_t samplerId;
+};
+
+template<typename ColorComputer>
+glm::vec3 ColorSampler::ComputeSamplesAndColor(const int maxSamples, const int dimensions, const uint64_t randomKey, ColorComputer&& colorComputer) const
+{
+    const ThreadSamplerStateScope stateScope(*this, Random::Generator(randomKey), maxSamples, dimensions);
+    SamplerState& state = stateScope.GetState();
+
+    glm::vec3 finalColor;
+    for (int i = 0; i < maxSamples; ++i) {
+        // Compute normalized sample. 
+        state.generator.SetSampleIndex(static_cast<uint64_t>(i));
+        const glm::vec3 sampleCoordinates = ComputeSampleCoordinate(state);
+        Random::GetThreadGenerator() = state.generator;
+
+        // Compute sample color.
+        const glm::vec3 sampleColor = colorComputer(sampleCoordinates);
+        finalColor += sampleColor;
+        ++state.samplesComputed;
+
+        if (NotifyColorSampleForEarlyExit(state, sampleColor)) {
+            break;
+        }
+
+        state.colorStatistics.AddSample(sampleColor);
+    }
+    finalColor /= static_cast<float>(state.samplesComputed);
+    return finalColor;
+}
+
+template<typename ColorComputer>
+void ColorSampler::AddSamples(ColorStatistics& pixelStatistics, const int firstSample, const int totalSamples, const int maxSamples, const int dimensions,
+    const uint64_t randomKey, ColorComputer&& colorComputer) const
+{
+    const ThreadSamplerStateScope stateScope(*this, Random::Generator(randomKey), maxSamples, dimensions);
+    SamplerState& state = stateScope.GetState();
+    state.samplesComputed = firstSample;
+    for (int i = firstSample; i < firstSample + totalSamples; ++i) {
+        state.generator.SetSampleIndex(static_cast<uint64_t>(i));
+        const glm::vec3 sampleCoordinates = ComputeSampleCoordinate(state);
+        Random::GetThreadGenerator() = state.generator;
+
+        pixelStatistics.AddSample(colorComputer(sampleCoordinates));
+        ++state.samplesComputed;
+    }
+}
+
+template<typename ColorComputer, typename PixelWriter>
+void ColorSampler::ComputeImage(const int width, const int height, const int maxSamplesPerPixel, const int dimensions, ColorComputer&& colorComputer,
+    PixelWriter&& pixelWriter) const
+{
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    std::vector<ColorStatistics> pixels;
+    std::vector<int> samplesToTake;
+
+    ImageSamplingProgress progress;
+    progress.width = width;
+    progress.height = height;
+    progress.maxSamplesPerPixel = maxSamplesPerPixel;
+    progress.totalPasses = 0;
+    progress.totalSamples = 0;
+    progress.elapsedSeconds = 0.f;
+    progress.pixels = &pixels;
+
+    if (!PlanImagePass(progress, samplesToTake)) {
+        for (int r = 0; r < height; ++r) {
+            for (int c = 0; c < width; ++c) {
+                pixelWriter(c, r, ComputeSamplesAndColor(maxSamplesPerPixel, dimensions, Random::PixelKey(c, r), [&](glm::vec3 inputSample) {
+                    return colorComputer(c, r, inputSample);
+                }));
+            }
+        }
+        return;
+    }
+
+    pixels.resize(static_cast<size_t>(width) * height);
+    do {
+        for (int r = 0; r < height; ++r) {
+            for (int c = 0; c < width; ++c) {
+                const size_t pixelIndex = static_cast<size_t>(r) * width + c;
+                const int newSamples = std::min(samplesToTake[pixelIndex], maxSamplesPerPixel - pixels[pixelIndex].totalSamples);
+                if (newSamples <= 0) {
+                    continue;
+                }
+                AddSamples(pixels[pixelIndex], pixels[pixelIndex].totalSamples, newSamples, maxSamplesPerPixel, dimensions, Random::PixelKey(c, r), [&](glm::vec3 inputSample) {
+                    return colorComputer(c, r, inputSample);
+                });
+                progress.totalSamples += newSamples;
+            }
+        }
+        ++progress.totalPasses;
+        progress.elapsedSeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - startTime).count();
+    } while (PlanImagePass(progress, samplesToTake));
+
+    for (int r = 0; r < height; ++r) {
+        for (int c = 0; c < width; ++c) {
+            pixelWriter(c, r, pixels[static_cast<size_t>(r) * width + c].mean);
+        }
+    }
+}
@@ -17,10 +17,17 @@ glm::vec3 JitterColorSampler::ComputeSampleCoordinate(SamplerState& state) const
     return gridCellOffset + gridCellSize * random;
 }
 
-std::unique_ptr<SamplerState> JitterColorSampler::CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const
+std::unique_ptr<SamplerState> JitterColorSampler::CreateSampler(const Random::Generator& generator, const int maxSamples, const int dimensions) const
 {
-    std::unique_ptr<JitterSamplerState> state = make_unique<JitterSamplerState>(randomDevice, maxSamples, dimensions);
-    state->samplesPerCell = maxSamples / (gridSize.x * gridSize.y * gridSize.z);
-    assert(state->samplesPerCell > 0);
+    std::unique_ptr<JitterSamplerState> state = make_unique<JitterSamplerState>();
+    ResetSampler(*state.get(), generator, maxSamples, dimensions);
     return std::move(state);
+}
+
+void JitterColorSampler::ResetSampler(SamplerState& state, const Random::Generator& generator, const int maxSamples, const int dimensions) const
+{
+    ColorSampler::ResetSampler(state, generator, maxSamples, dimensions);
+    JitterSamplerState& jitterState = static_cast<JitterSamplerState&>(state);
+    jitterState.samplesPerCell = maxSamples / (gridSize.x * gridSize.y * gridSize.z);
+    assert(jitterState.samplesPerCell > 0);
 }
\ No newline at end of file
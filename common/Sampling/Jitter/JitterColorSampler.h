@@ -4,8 +4,13 @@
 
 struct JitterSamplerState : public SamplerState
 {
-    JitterSamplerState(std::random_device& device, int inputMax, int inputDim) :
-        SamplerState(device, inputMax, inputDim), samplesPerCell(0)
+    JitterSamplerState() :
+        samplesPerCell(0)
+    {
+    }
+
+    JitterSamplerState(const Random::Generator& inputGenerator, int inputMax, int inputDim) :
+        SamplerState(inputGenerator, inputMax, inputDim), samplesPerCell(0)
     {
     }
 
@@ -17,7 +22,8 @@ class JitterColorSampler : public ColorSampler
 public:
     void SetGridSize(glm::ivec3 inputGridSize);
 
-    virtual std::unique_ptr<SamplerState> CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const override;
+    virtual std::unique_ptr<SamplerState> CreateSampler(const Random::Generator& generator, const int maxSamples, const int dimensions) const override;
+    virtual void ResetSampler(SamplerState& state, const Random::Generator& generator, const int maxSamples, const int dimensions) const override;
     virtual glm::vec3 ComputeSampleCoordinate(SamplerState& state) const override;
 private:
     glm::ivec3 gridSize;
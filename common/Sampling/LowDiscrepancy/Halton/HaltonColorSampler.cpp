@@ -0,0 +1,53 @@
+#include "common/Sampling/LowDiscrepancy/Halton/HaltonColorSampler.h"
+#include "common/Utility/Hash/Hash.h"
+
+namespace
+{
+
+const uint32_t HALTON_PRIMES[HaltonColorSampler::MAX_DIMENSIONS] = {
+    2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+    59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131
+};
+
+const int MANTISSA_BITS = 24;
+const float LARGEST_FLOAT_BELOW_ONE = 0.99999994f;
+
+}
+
+HaltonColorSampler::HaltonColorSampler()
+{
+    for (uint32_t d = 0; d < MAX_DIMENSIONS; ++d) {
+        totalDigits[d] = static_cast<int>(std::ceil(MANTISSA_BITS * std::log(2.0) / std::log(static_cast<double>(HALTON_PRIMES[d]))));
+    }
+}
+
+uint32_t HaltonColorSampler::GetTotalDimensions() const
+{
+    return MAX_DIMENSIONS;
+}
+
+float HaltonColorSampler::Evaluate(uint64_t index, uint32_t dimension, uint64_t scramble) const
+{
+    assert(dimension < MAX_DIMENSIONS);
+    const uint64_t base = HALTON_PRIMES[dimension];
+    const uint64_t dimensionSeed = Hash::MixBits(scramble + dimension * 0x9E3779B97F4A7C15ULL);
+    const double inverseBase = 1.0 / static_cast<double>(base);
+
+    // Digit i of the index becomes digit i after the point. Each digit is shifted by a random amount; for Owen
+    // scrambling the shift also depends on the digits already placed, i.e. on the node of the digit tree.
+    double result = 0.0;
+    double digitWeight = inverseBase;
+    uint64_t node = 0;
+    for (int i = 0; i < totalDigits[dimension]; ++i) {
+        const uint64_t digit = index % base;
+        index /= base;
+
+        const uint64_t nodeSeed = (scrambling == SequenceScrambling::OWEN) ? Hash::MixBits(node + (static_cast<uint64_t>(i) << 56)) : static_cast<uint64_t>(i);
+        const uint64_t shift = Hash::MixBits(dimensionSeed ^ nodeSeed) % base;
+        result += static_cast<double>((digit + shift) % base) * digitWeight;
+
+        node = node * base + digit;
+        digitWeight *= inverseBase;
+    }
+    return std::min(static_cast<float>(result), LARGEST_FLOAT_BELOW_ONE);
+}
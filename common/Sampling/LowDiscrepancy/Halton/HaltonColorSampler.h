@@ -0,0 +1,19 @@
+#pragma once
+
+#include "common/Sampling/LowDiscrepancy/LowDiscrepancyColorSampler.h"
+
+// Halton sequence: dimension i is the radical inverse of the sample index in the i-th prime base. Unlike Sobol it has
+// no preferred sample counts, but the higher dimensions (large bases) need scrambling to be usable at all.
+class HaltonColorSampler : public LowDiscrepancyColorSampler
+{
+public:
+    HaltonColorSampler();
+
+    virtual uint32_t GetTotalDimensions() const override;
+    virtual float Evaluate(uint64_t index, uint32_t dimension, uint64_t scramble) const override;
+
+    static const uint32_t MAX_DIMENSIONS = 32;
+private:
+    // Number of digits it takes for each base to resolve a float mantissa; scrambled trailing zeros still contribute.
+    int totalDigits[MAX_DIMENSIONS];
+};
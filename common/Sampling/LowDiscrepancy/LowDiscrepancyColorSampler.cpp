@@ -0,0 +1,17 @@
+#include "common/Sampling/LowDiscrepancy/LowDiscrepancyColorSampler.h"
+
+LowDiscrepancyColorSampler::LowDiscrepancyColorSampler() :
+    scrambling(SequenceScrambling::OWEN)
+{
+}
+
+void LowDiscrepancyColorSampler::ResetSampler(SamplerState& state, const Random::Generator& generator, const int maxSamples, const int dimensions) const
+{
+    ColorSampler::ResetSampler(state, generator, maxSamples, dimensions);
+    state.generator.SetSequence(this, static_cast<uint32_t>(maxSamples));
+}
+
+void LowDiscrepancyColorSampler::SetScrambling(SequenceScrambling inputScrambling)
+{
+    scrambling = inputScrambling;
+}
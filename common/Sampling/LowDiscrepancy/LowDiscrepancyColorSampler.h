@@ -0,0 +1,29 @@
+#pragma once
+
+#include "common/Sampling/ColorSampler.h"
+
+enum class SequenceScrambling
+{
+    // Every digit of every dimension is permuted the same way for all points. Cheap, keeps the stratification of the
+    // set, but neighbouring strata stay correlated.
+    RANDOM_DIGIT,
+    // Nested scrambling: the permutation of a digit also depends on all the digits before it (Owen). Keeps the
+    // stratification and removes the correlation, which usually buys noticeably faster convergence.
+    OWEN
+};
+
+// Base class for samplers that take their sample vectors from a deterministic point set instead of from Philox. The
+// point set is scrambled per pixel and also drives the dimensions the rest of the sample draws from the thread's
+// generator (lens, lights, Russian roulette) until it runs out of dimensions, after which Philox takes over.
+class LowDiscrepancyColorSampler : public ColorSampler, public Random::Sequence
+{
+public:
+    LowDiscrepancyColorSampler();
+
+    virtual void ResetSampler(SamplerState& state, const Random::Generator& generator, const int maxSamples, const int dimensions) const override;
+
+    void SetScrambling(SequenceScrambling inputScrambling);
+
+protected:
+    SequenceScrambling scrambling;
+};
@@ -0,0 +1,108 @@
+#include "common/Sampling/LowDiscrepancy/Sobol/SobolColorSampler.h"
+#include "common/Utility/Hash/Hash.h"
+
+namespace
+{
+
+struct SobolPolynomial
+{
+    int degree;
+    uint32_t coefficients;
+    uint32_t initialDirections[7];
+};
+
+// new-joe-kuo-6.21201, dimensions 2 to 21. The first dimension is the van der Corput sequence.
+const SobolPolynomial SOBOL_POLYNOMIALS[SobolColorSampler::MAX_DIMENSIONS - 1] = {
+    { 1, 0, { 1 } },
+    { 2, 1, { 1, 3 } },
+    { 3, 1, { 1, 3, 1 } },
+    { 3, 2, { 1, 1, 1 } },
+    { 4, 1, { 1, 1, 3, 3 } },
+    { 4, 4, { 1, 3, 5, 13 } },
+    { 5, 2, { 1, 1, 5, 5, 17 } },
+    { 5, 4, { 1, 1, 5, 5, 5 } },
+    { 5, 7, { 1, 1, 7, 11, 19 } },
+    { 5, 11, { 1, 1, 5, 1, 1 } },
+    { 5, 13, { 1, 1, 1, 3, 11 } },
+    { 5, 14, { 1, 3, 5, 5, 31 } },
+    { 6, 1, { 1, 3, 3, 9, 7, 49 } },
+    { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+    { 6, 16, { 1, 3, 1, 13, 27, 49 } },
+    { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+    { 6, 22, { 1, 3, 1, 15, 13, 25 } },
+    { 6, 25, { 1, 1, 5, 5, 19, 61 } },
+    { 7, 1, { 1, 3, 7, 11, 23, 15, 103 } },
+    { 7, 4, { 1, 3, 7, 13, 13, 15, 69 } }
+};
+
+uint32_t ReverseBits(uint32_t value)
+{
+    value = ((value >> 1) & 0x55555555u) | ((value & 0x55555555u) << 1);
+    value = ((value >> 2) & 0x33333333u) | ((value & 0x33333333u) << 2);
+    value = ((value >> 4) & 0x0F0F0F0Fu) | ((value & 0x0F0F0F0Fu) << 4);
+    value = ((value >> 8) & 0x00FF00FFu) | ((value & 0x00FF00FFu) << 8);
+    return (value >> 16) | (value << 16);
+}
+
+// Hash-based approximation of an Owen scramble of the bits (Burley, "Practical Hash-based Owen Scrambling"): the
+// Laine-Karras permutation only lets lower bits affect higher ones, so it is applied to the reversed value.
+uint32_t OwenScramble(uint32_t value, uint32_t seed)
+{
+    value = ReverseBits(value);
+    value += seed;
+    value ^= value * 0x6c50b47cu;
+    value ^= value * 0xb82f1e52u;
+    value ^= value * 0xc7afe638u;
+    value ^= value * 0x8d22f6e6u;
+    return ReverseBits(value);
+}
+
+}
+
+SobolColorSampler::SobolColorSampler()
+{
+    for (int bit = 0; bit < DIRECTION_BITS; ++bit) {
+        directions[0][bit] = 1u << (DIRECTION_BITS - 1 - bit);
+    }
+
+    for (uint32_t d = 1; d < MAX_DIMENSIONS; ++d) {
+        const SobolPolynomial& polynomial = SOBOL_POLYNOMIALS[d - 1];
+        uint32_t* v = directions[d];
+        for (int bit = 0; bit < polynomial.degree; ++bit) {
+            v[bit] = polynomial.initialDirections[bit] << (DIRECTION_BITS - 1 - bit);
+        }
+        for (int bit = polynomial.degree; bit < DIRECTION_BITS; ++bit) {
+            v[bit] = v[bit - polynomial.degree] ^ (v[bit - polynomial.degree] >> polynomial.degree);
+            for (int k = 1; k < polynomial.degree; ++k) {
+                if ((polynomial.coefficients >> (polynomial.degree - 1 - k)) & 1) {
+                    v[bit] ^= v[bit - k];
+                }
+            }
+        }
+    }
+}
+
+uint32_t SobolColorSampler::GetTotalDimensions() const
+{
+    return MAX_DIMENSIONS;
+}
+
+float SobolColorSampler::Evaluate(uint64_t index, uint32_t dimension, uint64_t scramble) const
+{
+    assert(dimension < MAX_DIMENSIONS);
+    uint32_t value = 0;
+    uint32_t remainingBits = static_cast<uint32_t>(index);
+    for (int bit = 0; remainingBits; ++bit, remainingBits >>= 1) {
+        if (remainingBits & 1) {
+            value ^= directions[dimension][bit];
+        }
+    }
+
+    const uint32_t seed = static_cast<uint32_t>(Hash::MixBits(scramble + dimension * 0x9E3779B97F4A7C15ULL));
+    if (scrambling == SequenceScrambling::OWEN) {
+        value = OwenScramble(value, seed);
+    } else {
+        value ^= seed;
+    }
+    return static_cast<float>(value >> 8) * (1.f / 16777216.f);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "common/Sampling/LowDiscrepancy/LowDiscrepancyColorSampler.h"
+
+// Sobol sequence with the Joe-Kuo direction numbers. Every power-of-two prefix of the points is a (t, m, s)-net in
+// base 2, so sample counts of 2^k give the best results.
+class SobolColorSampler : public LowDiscrepancyColorSampler
+{
+public:
+    SobolColorSampler();
+
+    virtual uint32_t GetTotalDimensions() const override;
+    virtual float Evaluate(uint64_t index, uint32_t dimension, uint64_t scramble) const override;
+
+    static const uint32_t MAX_DIMENSIONS = 21;
+private:
+    static const int DIRECTION_BITS = 32;
+    uint32_t directions[MAX_DIMENSIONS][DIRECTION_BITS];
+};
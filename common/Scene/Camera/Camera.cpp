@@ -1,5 +1,20 @@
 #include "common/Scene/Camera/Camera.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
 
 Camera::Camera()
 {
-}
\ No newline at end of file
+}
+
+std::shared_ptr<Ray> Camera::GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const
+{
+    std::shared_ptr<Ray> ray = std::make_shared<Ray>();
+    GenerateRayForNormalizedCoordinates(coordinate, *ray.get());
+    return ray;
+}
+
+std::shared_ptr<Ray> Camera::GenerateRandomRayFromLenArea(glm::vec2 coordinate) const
+{
+    std::shared_ptr<Ray> ray = std::make_shared<Ray>();
+    GenerateRandomRayFromLenArea(coordinate, *ray.get());
+    return ray;
+}
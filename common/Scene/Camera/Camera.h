@@ -7,6 +7,10 @@ class Camera : public SceneObject
 public:
     Camera();
 
-    virtual std::shared_ptr<class Ray> GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const = 0;
-    virtual std::shared_ptr<class Ray> GenerateRandomRayFromLenArea(glm::vec2 coordinate) const = 0;
+    // Overwrite outputRay so that a caller can keep the ray on the stack; rendering creates one ray per sample.
+    virtual void GenerateRayForNormalizedCoordinates(glm::vec2 coordinate, class Ray& outputRay) const = 0;
+    virtual void GenerateRandomRayFromLenArea(glm::vec2 coordinate, class Ray& outputRay) const = 0;
+
+    std::shared_ptr<class Ray> GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const;
+    std::shared_ptr<class Ray> GenerateRandomRayFromLenArea(glm::vec2 coordinate) const;
 };
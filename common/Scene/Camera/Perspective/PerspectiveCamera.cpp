@@ -1,12 +1,13 @@
 #include "common/Scene/Camera/Perspective/PerspectiveCamera.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Utility/Random/Random.h"
 
 PerspectiveCamera::PerspectiveCamera(float aspectRatio, float inputFov):
     aspectRatio(aspectRatio), fov(inputFov * PI / 180.f), zNear(0.f), zFar(std::numeric_limits<float>::max())
 {
 }
 
-std::shared_ptr<Ray> PerspectiveCamera::GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const
+void PerspectiveCamera::GenerateRayForNormalizedCoordinates(glm::vec2 coordinate, Ray& outputRay) const
 {
     // Send ray from the camera to the image plane -- make the assumption that the image plane is at z = 1 in camera space.
     const glm::vec3 rayOrigin = glm::vec3(GetPosition());
@@ -25,10 +26,10 @@ std::shared_ptr<Ray> PerspectiveCamera::GenerateRayForNormalizedCoordinates(glm:
     const glm::vec3 targetPosition = rayOrigin + glm::vec3(GetForwardDirection()) + glm::vec3(GetRightDirection()) * xOffset + glm::vec3(GetUpDirection()) * yOffset;
 
     const glm::vec3 rayDirection = glm::normalize(targetPosition - rayOrigin);
-    return std::make_shared<Ray>(rayOrigin + rayDirection * zNear, rayDirection, zFar - zNear);
+    outputRay = Ray(rayOrigin + rayDirection * zNear, rayDirection, zFar - zNear);
 }
 
-std::shared_ptr<Ray> PerspectiveCamera::GenerateRandomRayFromLenArea(glm::vec2 coordinate) const
+void PerspectiveCamera::GenerateRandomRayFromLenArea(glm::vec2 coordinate, Ray& outputRay) const
 {
     // Assume focal plane is at focalPlaneZ
     float focalPlaneZ = 3.5;
@@ -49,15 +50,16 @@ std::shared_ptr<Ray> PerspectiveCamera::GenerateRandomRayFromLenArea(glm::vec2 c
     glm::vec3 focalPoint = center + glm::vec3(GetForwardDirection()) * focalPlaneZ + glm::vec3(GetRightDirection()) * xOffset * focalPlaneZ + glm::vec3(GetUpDirection()) * yOffset * focalPlaneZ;
      
     // generate a random point in the circular area of the len
-    float r=1.f*std::rand()/RAND_MAX*lenRadius;
-    float theta=2*PI*1.f*std::rand()/RAND_MAX;
+    Random::Generator& generator = Random::GetThreadGenerator();
+    float r=generator.NextFloat()*lenRadius;
+    float theta=2*PI*generator.NextFloat();
     float x=r*std::cos(theta);
     float y=r*std::sin(theta);
     // world space to camera space
     glm::vec3 rayOrigin = center + glm::vec3(GetRightDirection()) * x + glm::vec3(GetUpDirection()) * y;
     // the random Ray Direction
     glm::vec3 rayDirection = glm::normalize(focalPoint - rayOrigin);
-    return std::make_shared<Ray>(rayOrigin + rayDirection * zNear, rayDirection, zFar - zNear);
+    outputRay = Ray(rayOrigin + rayDirection * zNear, rayDirection, zFar - zNear);
 }
 
 void PerspectiveCamera::SetZNear(float input)
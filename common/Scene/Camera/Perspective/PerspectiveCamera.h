@@ -7,8 +7,10 @@ class PerspectiveCamera : public Camera
 public:
     // inputFov is in degrees. 
     PerspectiveCamera(float aspectRatio, float inputFov);
-    virtual std::shared_ptr<class Ray> GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const override;
-    virtual std::shared_ptr<class Ray> GenerateRandomRayFromLenArea(glm::vec2 coordinate) const override;
+    using Camera::GenerateRayForNormalizedCoordinates;
+    using Camera::GenerateRandomRayFromLenArea;
+    virtual void GenerateRayForNormalizedCoordinates(glm::vec2 coordinate, class Ray& outputRay) const override;
+    virtual void GenerateRandomRayFromLenArea(glm::vec2 coordinate, class Ray& outputRay) const override;
     
     void SetZNear(float input);
     void SetZFar(float input);
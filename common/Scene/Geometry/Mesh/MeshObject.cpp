@@ -4,6 +4,7 @@
 #include "common/Scene/Geometry/Ray/Ray.h"
 #include "common/Scene/SceneObject.h"
 #include "common/Intersection/IntersectionState.h"
+#include "common/Utility/Hash/Hash.h"
 
 MeshObject::MeshObject() :
     storedMaterial(nullptr)
@@ -24,6 +25,15 @@ void MeshObject::AddPrimitive(std::shared_ptr<PrimitiveBase> newPrimitive)
     elements.emplace_back(std::move(newPrimitive));
 }
 
+void MeshObject::AddPrimitives(std::vector<std::shared_ptr<PrimitiveBase>> newPrimitives)
+{
+    if (elements.empty()) {
+        elements = std::move(newPrimitives);
+        return;
+    }
+    elements.insert(elements.end(), std::make_move_iterator(newPrimitives.begin()), std::make_move_iterator(newPrimitives.end()));
+}
+
 void MeshObject::Finalize()
 {
     boundingBox.Reset();
@@ -46,6 +56,33 @@ bool MeshObject::Trace(const SceneObject* parentObject, class Ray* inputRay, str
     return acceleration->Trace(parentObject, inputRay, outputIntersection);
 }
 
+uint64_t MeshObject::ComputeGeometryHash(uint64_t seed) const
+{
+    uint64_t hash = Hash::HashCombine(seed, static_cast<uint64_t>(elements.size()));
+    for (size_t i = 0; i < elements.size(); ++i) {
+        const PrimitiveBase* element = elements[i].get();
+        if (element->IsAnalytic()) {
+            const Box bounds = element->GetBoundingBox();
+            hash = Hash::HashBytes(&bounds.minVertex, sizeof(glm::vec3), hash);
+            hash = Hash::HashBytes(&bounds.maxVertex, sizeof(glm::vec3), hash);
+            continue;
+        }
+
+        const int totalVertices = element->GetTotalVertices();
+        const bool hasVertexNormals = element->HasVertexNormals();
+        hash = Hash::HashCombine(hash, static_cast<uint64_t>(totalVertices) * 2 + (hasVertexNormals ? 1 : 0));
+        for (int v = 0; v < totalVertices; ++v) {
+            const glm::vec3 position = element->GetVertexPosition(v);
+            hash = Hash::HashBytes(&position, sizeof(glm::vec3), hash);
+            if (hasVertexNormals) {
+                const glm::vec3 normal = element->GetVertexNormal(v);
+                hash = Hash::HashBytes(&normal, sizeof(glm::vec3), hash);
+            }
+        }
+    }
+    return hash;
+}
+
 const Material* MeshObject::GetMaterial() const
 {
     return storedMaterial.get();
@@ -14,6 +14,7 @@ public:
     void SetName(const std::string& input);
     std::string GetName() const { return meshName; }
     void AddPrimitive(std::shared_ptr<class PrimitiveBase> newPrimitive);
+    void AddPrimitives(std::vector<std::shared_ptr<class PrimitiveBase>> newPrimitives);
     virtual void CreateAccelerationData(AccelerationTypes perObjectType);
 
     virtual Box GetBoundingBox() const override
@@ -26,6 +27,10 @@ public:
 
     virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
 
+    // Hash of the mesh's shape in object space (vertex positions and normals, bounds of analytic primitives), for keying
+    // caches of results computed over the scene. The material is not included.
+    virtual uint64_t ComputeGeometryHash(uint64_t seed) const;
+
     friend class SceneObject;
 protected:
     std::vector<std::shared_ptr<class PrimitiveBase>> elements;
@@ -0,0 +1,95 @@
+#include "common/Scene/Geometry/Mesh/Streaming/GeometryChunkCache.h"
+#include "common/Scene/Geometry/Mesh/Streaming/StreamingMeshObject.h"
+#include "common/Acceleration/AccelerationStructure.h"
+
+ResidentGeometryChunk::ResidentGeometryChunk() :
+    memoryFootprint(0)
+{
+}
+
+ResidentGeometryChunk::~ResidentGeometryChunk()
+{
+}
+
+GeometryChunkCache::GeometryChunkCache(size_t inputMemoryBudget) :
+    memoryBudget(inputMemoryBudget), residentMemory(0)
+{
+}
+
+void GeometryChunkCache::SetMemoryBudget(size_t inputMemoryBudget)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    memoryBudget = inputMemoryBudget;
+    EvictOverBudget(nullptr);
+}
+
+size_t GeometryChunkCache::GetMemoryBudget() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return memoryBudget;
+}
+
+size_t GeometryChunkCache::GetResidentMemory() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return residentMemory;
+}
+
+std::shared_ptr<const ResidentGeometryChunk> GeometryChunkCache::Acquire(const GeometryChunk& chunk)
+{
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto existing = entries.find(&chunk);
+        if (existing != entries.end()) {
+            lru.splice(lru.begin(), lru, existing->second.lruPosition);
+            return existing->second.data;
+        }
+    }
+
+    // Page in without holding the lock so that other threads can keep tracing resident chunks in the meantime.
+    std::shared_ptr<const ResidentGeometryChunk> data = chunk.PageIn();
+    if (!data) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto existing = entries.find(&chunk);
+    if (existing != entries.end()) {
+        // Another thread paged the same chunk in first. Use its copy and let ours go.
+        lru.splice(lru.begin(), lru, existing->second.lruPosition);
+        return existing->second.data;
+    }
+
+    DIAGNOSTICS_STAT(DiagnosticsType::GEOMETRY_CHUNK_PAGE_INS);
+    lru.push_front(&chunk);
+    CacheEntry& entry = entries[&chunk];
+    entry.data = data;
+    entry.lruPosition = lru.begin();
+    residentMemory += data->memoryFootprint;
+    EvictOverBudget(&chunk);
+    return data;
+}
+
+void GeometryChunkCache::Remove(const GeometryChunk& chunk)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto existing = entries.find(&chunk);
+    if (existing == entries.end()) {
+        return;
+    }
+    residentMemory -= existing->second.data->memoryFootprint;
+    lru.erase(existing->second.lruPosition);
+    entries.erase(existing);
+}
+
+void GeometryChunkCache::EvictOverBudget(const GeometryChunk* keep)
+{
+    while (residentMemory > memoryBudget && !lru.empty() && lru.back() != keep) {
+        auto evicted = entries.find(lru.back());
+        assert(evicted != entries.end());
+        residentMemory -= evicted->second.data->memoryFootprint;
+        entries.erase(evicted);
+        lru.pop_back();
+        DIAGNOSTICS_STAT(DiagnosticsType::GEOMETRY_CHUNK_EVICTIONS);
+    }
+}
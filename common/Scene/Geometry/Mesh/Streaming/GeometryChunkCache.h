@@ -0,0 +1,59 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Scene/Geometry/Primitives/Triangle/Triangle.h"
+#include <list>
+#include <mutex>
+
+class AccelerationStructure;
+class GeometryChunk;
+
+// Geometry and acceleration structure of a chunk that is currently in memory.
+struct ResidentGeometryChunk
+{
+    // The primitives do not own the triangles; they are destroyed together with this object. The acceleration structure
+    // must be declared after the triangles so that it is destroyed first.
+    std::vector<Triangle> triangles;
+    std::unique_ptr<AccelerationStructure> acceleration;
+    size_t memoryFootprint;
+
+    ResidentGeometryChunk();
+    ~ResidentGeometryChunk();
+};
+
+// Keeps the most recently used geometry chunks in memory and evicts the least recently used ones once the total
+// footprint goes over the memory budget. Anything that still holds a ResidentGeometryChunk (such as an intersection
+// that refers to one of its triangles) keeps it alive after eviction, so the budget can be exceeded temporarily.
+// Safe to use from multiple threads.
+class GeometryChunkCache
+{
+public:
+    GeometryChunkCache(size_t inputMemoryBudget);
+
+    void SetMemoryBudget(size_t inputMemoryBudget);
+    size_t GetMemoryBudget() const;
+    size_t GetResidentMemory() const;
+
+    // Returns the resident data for the chunk, paging it in on a miss. Returns nullptr if the chunk could not be loaded.
+    std::shared_ptr<const ResidentGeometryChunk> Acquire(const GeometryChunk& chunk);
+
+    // Forgets the chunk. Called when its mesh is destroyed since the resident triangles point back at the mesh.
+    void Remove(const GeometryChunk& chunk);
+private:
+    typedef std::list<const GeometryChunk*> LRUList;
+    struct CacheEntry
+    {
+        std::shared_ptr<const ResidentGeometryChunk> data;
+        LRUList::iterator lruPosition;
+    };
+
+    void EvictOverBudget(const GeometryChunk* keep);
+
+    mutable std::mutex cacheMutex;
+    size_t memoryBudget;
+    size_t residentMemory;
+
+    // Most recently used at the front.
+    LRUList lru;
+    std::unordered_map<const GeometryChunk*, CacheEntry> entries;
+};
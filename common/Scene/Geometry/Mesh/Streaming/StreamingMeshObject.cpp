@@ -0,0 +1,115 @@
+#include "common/Scene/Geometry/Mesh/Streaming/StreamingMeshObject.h"
+#include "common/Scene/Geometry/Mesh/Streaming/GeometryChunkCache.h"
+#include "common/Utility/Mesh/Streaming/GeometryChunkFile.h"
+#include "common/Utility/Mesh/Loading/MeshLoader.h"
+#include "common/Intersection/IntersectionState.h"
+#include "common/Utility/Hash/Hash.h"
+
+namespace
+{
+
+// Rough per-triangle cost of the acceleration structure (node pointers and tree nodes) on top of the triangle itself.
+const size_t ACCELERATION_BYTES_PER_PRIMITIVE = 128;
+
+}
+
+GeometryChunk::GeometryChunk(StreamingMeshObject* inputParent, size_t inputChunkIndex, const Box& inputBounds) :
+    parentMesh(inputParent), chunkIndex(inputChunkIndex), bounds(inputBounds)
+{
+}
+
+bool GeometryChunk::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    std::shared_ptr<const ResidentGeometryChunk> data = parentMesh->chunkCache->Acquire(*this);
+    if (!data) {
+        return false;
+    }
+
+    const bool hit = data->acceleration->Trace(parentObject, inputRay, outputIntersection);
+    if (hit && outputIntersection) {
+        // The intersection now points at one of our triangles so the chunk has to outlive a possible eviction.
+        outputIntersection->intersectedPrimitiveOwner = data;
+    }
+    return hit;
+}
+
+std::shared_ptr<const ResidentGeometryChunk> GeometryChunk::PageIn() const
+{
+    return parentMesh->PageInChunk(chunkIndex);
+}
+
+StreamingMeshObject::StreamingMeshObject(std::shared_ptr<const GeometryChunkFile> inputChunkFile, size_t inputMeshIndex, std::shared_ptr<GeometryChunkCache> inputChunkCache) :
+    chunkFile(std::move(inputChunkFile)), meshIndex(inputMeshIndex), chunkCache(std::move(inputChunkCache)), chunkAccelerationType(AccelerationTypes::BVH)
+{
+    assert(chunkFile && chunkCache && meshIndex < chunkFile->GetMeshes().size());
+    const GeometryChunkFile::MeshRecord& mesh = chunkFile->GetMeshes()[meshIndex];
+    SetName(mesh.name);
+    for (size_t i = 0; i < mesh.chunks.size(); ++i) {
+        chunks.push_back(std::make_shared<GeometryChunk>(this, i, mesh.chunks[i].bounds));
+    }
+}
+
+StreamingMeshObject::~StreamingMeshObject()
+{
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        chunkCache->Remove(*chunks[i]);
+    }
+}
+
+void StreamingMeshObject::Finalize()
+{
+    // Only the chunk bounds are needed here; nothing is paged in until a ray reaches a chunk.
+    boundingBox.Reset();
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        boundingBox.IncludeBox(chunks[i]->GetBoundingBox());
+    }
+    assert(acceleration);
+    acceleration->Initialize(chunks);
+}
+
+void StreamingMeshObject::CreateAccelerationData(AccelerationTypes perObjectType)
+{
+    MeshObject::CreateAccelerationData(perObjectType);
+    chunkAccelerationType = perObjectType;
+}
+
+uint64_t StreamingMeshObject::ComputeGeometryHash(uint64_t seed) const
+{
+    return Hash::HashCombine(Hash::HashCombine(seed, chunkFile->GetSourceHash()), static_cast<uint64_t>(meshIndex));
+}
+
+void StreamingMeshObject::ConfigureChunkAccelerationStructure(std::function<void(AccelerationStructure*)> configure)
+{
+    configureChunkAcceleration = std::move(configure);
+}
+
+std::shared_ptr<const ResidentGeometryChunk> StreamingMeshObject::PageInChunk(size_t chunkIndex)
+{
+    MeshAttributeView view;
+    if (!chunkFile->GetChunkView(meshIndex, chunkIndex, view)) {
+        std::cerr << "WARNING: Chunk " << chunkIndex << " of " << GetName() << " is malformed. Skipping it." << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<ResidentGeometryChunk> data = std::make_shared<ResidentGeometryChunk>();
+    const size_t totalTriangles = view.totalIndices / 3;
+    data->triangles.reserve(totalTriangles);
+    std::vector<std::shared_ptr<PrimitiveBase>> primitives(totalTriangles);
+    for (size_t t = 0; t < totalTriangles; ++t) {
+        data->triangles.emplace_back(this);
+        Triangle& triangle = data->triangles.back();
+        MeshLoader::LoadFaceIntoPrimitive(3, view.indices + t * 3, triangle, view);
+        triangle.Finalize();
+
+        // Non-owning: the triangles belong to the resident chunk, which outlives its acceleration structure.
+        primitives[t] = std::shared_ptr<PrimitiveBase>(std::shared_ptr<PrimitiveBase>(), &triangle);
+    }
+
+    data->acceleration = AccelerationGenerator::CreateStructureFromType(chunkAccelerationType);
+    if (configureChunkAcceleration) {
+        configureChunkAcceleration(data->acceleration.get());
+    }
+    data->acceleration->Initialize(primitives);
+    data->memoryFootprint = sizeof(ResidentGeometryChunk) + totalTriangles * (sizeof(Triangle) + ACCELERATION_BYTES_PER_PRIMITIVE);
+    return data;
+}
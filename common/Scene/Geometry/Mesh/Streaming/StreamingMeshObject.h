@@ -0,0 +1,62 @@
+#pragma once
+
+#include "common/Scene/Geometry/Mesh/MeshObject.h"
+
+class GeometryChunkFile;
+class GeometryChunkCache;
+struct ResidentGeometryChunk;
+
+// Stand-in for a piece of a streaming mesh in the mesh's acceleration structure. Only the bounds are kept in memory;
+// the triangles and their acceleration structure are paged in through the GeometryChunkCache when a ray reaches them.
+class GeometryChunk : public AccelerationNode
+{
+public:
+    GeometryChunk(class StreamingMeshObject* inputParent, size_t inputChunkIndex, const Box& inputBounds);
+
+    virtual Box GetBoundingBox() const override
+    {
+        return bounds;
+    }
+
+    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+
+    // Loads the chunk from disk and builds its acceleration structure. Called by the GeometryChunkCache on a miss.
+    std::shared_ptr<const ResidentGeometryChunk> PageIn() const;
+private:
+    class StreamingMeshObject* parentMesh;
+    size_t chunkIndex;
+    Box bounds;
+};
+
+// Mesh whose geometry lives in a GeometryChunkFile instead of in memory (see MeshLoader::LoadStreamingMesh). The mesh's
+// own acceleration structure is built over the chunk bounds and every chunk gets its own structure of the same type
+// when it is paged in.
+class StreamingMeshObject : public MeshObject
+{
+public:
+    StreamingMeshObject(std::shared_ptr<const GeometryChunkFile> inputChunkFile, size_t inputMeshIndex, std::shared_ptr<GeometryChunkCache> inputChunkCache);
+    virtual ~StreamingMeshObject();
+
+    virtual void Finalize() override;
+    virtual void CreateAccelerationData(AccelerationTypes perObjectType) override;
+
+    // The chunks are not paged in; the hash of the source file stands in for their contents.
+    virtual uint64_t ComputeGeometryHash(uint64_t seed) const override;
+
+    // Applied to the acceleration structure of every chunk as it is paged in.
+    void ConfigureChunkAccelerationStructure(std::function<void(class AccelerationStructure*)> configure);
+
+    size_t GetTotalChunks() const { return chunks.size(); }
+
+    friend class GeometryChunk;
+private:
+    std::shared_ptr<const ResidentGeometryChunk> PageInChunk(size_t chunkIndex);
+
+    std::shared_ptr<const GeometryChunkFile> chunkFile;
+    size_t meshIndex;
+    std::shared_ptr<GeometryChunkCache> chunkCache;
+
+    std::vector<std::shared_ptr<GeometryChunk>> chunks;
+    AccelerationTypes chunkAccelerationType;
+    std::function<void(class AccelerationStructure*)> configureChunkAcceleration;
+};
@@ -0,0 +1,107 @@
+#include "common/Scene/Geometry/Primitives/CompressedTriangle/CompressedTriangle.h"
+#include "common/Scene/Geometry/Primitives/CompressedTriangle/CompressedVertexBuffer.h"
+#include "common/Scene/Geometry/Primitives/Triangle/Triangle.h"
+#include "common/Scene/Geometry/Mesh/MeshObject.h"
+#include "common/Rendering/Material/Material.h"
+#include "common/Rendering/Textures/Texture.h"
+
+CompressedTriangle::CompressedTriangle(const MeshObject* inputParent, const CompressedVertexBuffer* inputVertices, const unsigned int* inputIndices) :
+    parentMesh(inputParent), vertices(inputVertices)
+{
+    assert(vertices);
+    for (int i = 0; i < 3; ++i) {
+        assert(inputIndices[i] < vertices->GetTotalVertices());
+        indices[i] = inputIndices[i];
+    }
+}
+
+bool CompressedTriangle::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    return Triangle::TraceTriangle(this, vertices->GetPosition(indices[0]), vertices->GetPosition(indices[1]), vertices->GetPosition(indices[2]),
+        parentObject, inputRay, outputIntersection);
+}
+
+Box CompressedTriangle::GetBoundingBox() const
+{
+    // Only needed while building the acceleration structure, so it is not worth storing.
+    Box boundingBox;
+    for (int i = 0; i < 3; ++i) {
+        const glm::vec3 position = vertices->GetPosition(indices[i]);
+        boundingBox.IncludeBox(Box(position, position));
+    }
+    return boundingBox;
+}
+
+void CompressedTriangle::SetVertexPosition(int index, glm::vec3 position)
+{
+    assert(false && "Compressed triangles are read-only. Modify the vertex buffer instead.");
+}
+
+void CompressedTriangle::SetVertexNormal(int index, glm::vec3 normal)
+{
+    assert(false && "Compressed triangles are read-only. Modify the vertex buffer instead.");
+}
+
+void CompressedTriangle::SetVertexUV(int index, glm::vec2 uv)
+{
+    assert(false && "Compressed triangles are read-only. Modify the vertex buffer instead.");
+}
+
+void CompressedTriangle::SetVertexTangentBitangent(int index, glm::vec3 tangent, glm::vec3 bitangent)
+{
+    assert(false && "Compressed triangles are read-only. Modify the vertex buffer instead.");
+}
+
+void CompressedTriangle::Finalize()
+{
+}
+
+glm::vec3 CompressedTriangle::GetVertexPosition(int index) const
+{
+    return vertices->GetPosition(indices[index]);
+}
+
+bool CompressedTriangle::HasVertexNormals() const
+{
+    return vertices->HasNormals();
+}
+
+bool CompressedTriangle::HasNormalMap() const
+{
+    const Material* material = parentMesh->GetMaterial();
+    return material && vertices->HasUVs() && material->GetTexture("normalTexture");
+}
+
+glm::vec3 CompressedTriangle::GetVertexNormal(int index) const
+{
+    return vertices->GetNormal(indices[index]);
+}
+
+glm::vec3 CompressedTriangle::GetVertexNormalMap(glm::vec2 uv, const glm::vec3& worldTangent, const glm::vec3& worldBitangent, const glm::vec3& worldNormal) const
+{
+    assert(HasNormalMap());
+    const Material* material = parentMesh->GetMaterial();
+    Texture* normalTexture = material->GetTexture("normalTexture");
+    glm::vec3 normalMap = glm::normalize(glm::vec3(normalTexture->Sample(uv)) * 2.f - 1.f);
+    return glm::mat3(worldTangent, worldBitangent, worldNormal) * normalMap;
+}
+
+glm::vec3 CompressedTriangle::GetPrimitiveNormal() const
+{
+    return Triangle::ComputeTriangleNormal(vertices->GetPosition(indices[0]), vertices->GetPosition(indices[1]), vertices->GetPosition(indices[2]));
+}
+
+glm::vec2 CompressedTriangle::GetVertexUV(int index) const
+{
+    return vertices->HasUVs() ? vertices->GetUV(indices[index]) : glm::vec2();
+}
+
+glm::vec3 CompressedTriangle::GetVertexTangent(int index) const
+{
+    return vertices->HasTangentsAndBitangents() ? vertices->GetTangent(indices[index]) : glm::vec3();
+}
+
+glm::vec3 CompressedTriangle::GetVertexBitangent(int index) const
+{
+    return vertices->HasTangentsAndBitangents() ? vertices->GetBitangent(indices[index]) : glm::vec3();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common/Scene/Geometry/Primitives/PrimitiveBase.h"
+
+class CompressedVertexBuffer;
+
+// Triangle that only stores three indices into its mesh's CompressedVertexBuffer rather than its own copy of every
+// vertex attribute. Attributes are decoded whenever they are requested, so the triangle is read-only once created.
+class CompressedTriangle : public PrimitiveBase
+{
+public:
+    CompressedTriangle(const class MeshObject* inputParent, const CompressedVertexBuffer* inputVertices, const unsigned int* inputIndices);
+
+    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual Box GetBoundingBox() const override;
+
+    virtual const class MeshObject* GetParentMeshObject() const override
+    {
+        return parentMesh;
+    }
+
+    virtual void SetVertexPosition(int index, glm::vec3 position) override;
+    virtual void SetVertexNormal(int index, glm::vec3 normal) override;
+    virtual void SetVertexUV(int index, glm::vec2 uv) override;
+    virtual void SetVertexTangentBitangent(int index, glm::vec3 tangent, glm::vec3 bitangent) override;
+
+    virtual int GetTotalVertices() const override
+    {
+        return 3;
+    }
+
+    virtual void Finalize() override;
+
+    virtual glm::vec3 GetVertexPosition(int index) const override;
+    virtual bool HasVertexNormals() const override;
+    virtual bool HasNormalMap() const override;
+    virtual glm::vec3 GetVertexNormal(int index) const override;
+    virtual glm::vec3 GetVertexNormalMap(glm::vec2 uv, const glm::vec3& worldTangent, const glm::vec3& worldBitangent, const glm::vec3& worldNormal) const override;
+    virtual glm::vec3 GetPrimitiveNormal() const override;
+    virtual glm::vec2 GetVertexUV(int index) const override;
+    virtual glm::vec3 GetVertexTangent(int index) const override;
+    virtual glm::vec3 GetVertexBitangent(int index) const override;
+private:
+    const class MeshObject* parentMesh;
+    const CompressedVertexBuffer* vertices;
+    std::array<unsigned int, 3> indices;
+};
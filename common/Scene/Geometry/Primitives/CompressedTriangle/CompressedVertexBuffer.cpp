@@ -0,0 +1,29 @@
+#include "common/Scene/Geometry/Primitives/CompressedTriangle/CompressedVertexBuffer.h"
+
+static_assert(sizeof(CompressedVertexBuffer::Vertex) == 24, "Compressed vertices are expected to be 24 bytes.");
+
+CompressedVertexBuffer::CompressedVertexBuffer(const MeshAttributeView& mesh) :
+    vertices(mesh.totalVertices), hasNormals(mesh.normals != nullptr), hasUVs(mesh.uvs != nullptr), hasTangentsAndBitangents(mesh.tangents && mesh.bitangents)
+{
+    glm::vec3 minimum(std::numeric_limits<float>::max());
+    glm::vec3 maximum(std::numeric_limits<float>::lowest());
+    for (unsigned int v = 0; v < mesh.totalVertices; ++v) {
+        minimum = glm::min(minimum, mesh.positions[v]);
+        maximum = glm::max(maximum, mesh.positions[v]);
+    }
+    if (!mesh.totalVertices) {
+        minimum = maximum = glm::vec3(0.f);
+    }
+    positionMinimum = minimum;
+    positionScale = Compression::ComputeQuantizationScale(minimum, maximum);
+
+    for (unsigned int v = 0; v < mesh.totalVertices; ++v) {
+        Vertex& vertex = vertices[v];
+        Compression::QuantizePosition(mesh.positions[v], positionMinimum, positionScale, vertex.position);
+        vertex.padding = 0;
+        vertex.normal = hasNormals ? Compression::EncodeOctahedral(mesh.normals[v]) : 0;
+        vertex.uv = hasUVs ? Compression::EncodeHalf2(mesh.uvs[v]) : 0;
+        vertex.tangent = hasTangentsAndBitangents ? Compression::EncodeOctahedral(mesh.tangents[v]) : 0;
+        vertex.bitangent = hasTangentsAndBitangents ? Compression::EncodeOctahedral(mesh.bitangents[v]) : 0;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Utility/Compression/Compression.h"
+#include "common/Utility/Mesh/Loading/MeshAttributeView.h"
+
+// Vertex attributes of a whole mesh stored once and in compressed form: positions are quantized to 16 bits per axis
+// relative to the mesh bounds, normals, tangents and bitangents use a 32-bit octahedral encoding and UVs are half floats.
+// That is 24 bytes per vertex instead of 56. Attributes are decoded on demand.
+class CompressedVertexBuffer
+{
+public:
+    struct Vertex
+    {
+        uint32_t normal;
+        uint32_t tangent;
+        uint32_t bitangent;
+        uint32_t uv;
+        uint16_t position[3];
+        uint16_t padding;
+    };
+
+    CompressedVertexBuffer(const MeshAttributeView& mesh);
+
+    size_t GetTotalVertices() const { return vertices.size(); }
+    size_t GetMemoryFootprint() const { return sizeof(CompressedVertexBuffer) + vertices.capacity() * sizeof(Vertex); }
+
+    bool HasNormals() const { return hasNormals; }
+    bool HasUVs() const { return hasUVs; }
+    bool HasTangentsAndBitangents() const { return hasTangentsAndBitangents; }
+
+    glm::vec3 GetPosition(unsigned int index) const
+    {
+        return Compression::DequantizePosition(vertices[index].position, positionMinimum, positionScale);
+    }
+
+    glm::vec3 GetNormal(unsigned int index) const
+    {
+        return Compression::DecodeOctahedral(vertices[index].normal);
+    }
+
+    glm::vec2 GetUV(unsigned int index) const
+    {
+        return Compression::DecodeHalf2(vertices[index].uv);
+    }
+
+    glm::vec3 GetTangent(unsigned int index) const
+    {
+        return Compression::DecodeOctahedral(vertices[index].tangent);
+    }
+
+    glm::vec3 GetBitangent(unsigned int index) const
+    {
+        return Compression::DecodeOctahedral(vertices[index].bitangent);
+    }
+private:
+    std::vector<Vertex> vertices;
+    glm::vec3 positionMinimum;
+    glm::vec3 positionScale;
+
+    bool hasNormals;
+    bool hasUVs;
+    bool hasTangentsAndBitangents;
+};
@@ -14,6 +14,7 @@ public:
     virtual int GetTotalVertices() const = 0;
     virtual void Finalize() = 0;
 
+    virtual glm::vec3 GetVertexPosition(int index) const = 0;
     virtual bool HasVertexNormals() const = 0;
     virtual bool HasNormalMap() const = 0;
     virtual glm::vec3 GetVertexNormal(int index) const = 0;
@@ -22,4 +23,10 @@ public:
     virtual glm::vec2 GetVertexUV(int index) const = 0;
     virtual glm::vec3 GetVertexTangent(int index) const = 0;
     virtual glm::vec3 GetVertexBitangent(int index) const = 0;
+
+    // Analytic primitives (e.g. Sphere) have no vertices to interpolate. Their shading frame and UVs are evaluated at the
+    // object space hit point instead.
+    virtual bool IsAnalytic() const { return false; }
+    virtual void ComputeAnalyticFrame(const glm::vec3& objectPosition, glm::vec3& normal, glm::vec3& tangent, glm::vec3& bitangent) const {}
+    virtual glm::vec2 ComputeAnalyticUV(const glm::vec3& objectPosition) const { return glm::vec2(); }
 };
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "common/Scene/Geometry/Primitives/Quad/Quad.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Intersection/IntersectionState.h"
+
+namespace
+{
+
+// Maximum distance of the fourth vertex from the plane of the other three, relative to the length of the diagonal.
+const float PLANARITY_TOLERANCE = 1e-4f;
+
+}
+
+Quad::Quad(class MeshObject* inputParent) :
+    Primitive<4>(inputParent), alpha11(1.f), beta11(1.f)
+{
+}
+
+glm::vec3 Quad::GetPrimitiveNormal() const
+{
+    return glm::normalize(glm::cross(positions[1] - positions[0], positions[3] - positions[0]));
+}
+
+void Quad::Finalize()
+{
+    Primitive<4>::Finalize();
+
+    // Solve positions[2] - positions[0] = alpha11 * e01 + beta11 * e03 in the plane that keeps the most precision.
+    const glm::vec3 e01 = positions[1] - positions[0];
+    const glm::vec3 e02 = positions[2] - positions[0];
+    const glm::vec3 e03 = positions[3] - positions[0];
+    const glm::vec3 normal = glm::cross(e01, e03);
+    const glm::vec3 absNormal = glm::abs(normal);
+    if (absNormal.x >= absNormal.y && absNormal.x >= absNormal.z) {
+        alpha11 = (e02.y * e03.z - e02.z * e03.y) / normal.x;
+        beta11 = (e01.y * e02.z - e01.z * e02.y) / normal.x;
+    } else if (absNormal.y >= absNormal.z) {
+        alpha11 = (e02.z * e03.x - e02.x * e03.z) / normal.y;
+        beta11 = (e01.z * e02.x - e01.x * e02.z) / normal.y;
+    } else {
+        alpha11 = (e02.x * e03.y - e02.y * e03.x) / normal.z;
+        beta11 = (e01.x * e02.y - e01.y * e02.x) / normal.z;
+    }
+}
+
+bool Quad::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    DIAGNOSTICS_STAT(DiagnosticsType::QUAD_INTERSECTIONS);
+    assert(parentObject);
+    // Convert ray into object space.
+    const glm::vec3 rayPos = glm::vec3(parentObject->GetWorldToObjectMatrix() * inputRay->GetPosition());
+    const glm::vec3 rayDir = glm::vec3(parentObject->GetWorldToObjectMatrix() * inputRay->GetForwardDirection());
+
+    // Lagae and Dutre, An Efficient Ray-Quadrilateral Intersection Test
+    // Paper: http://graphics.cs.kuleuven.be/publications/LD05ERQIT/LD05ERQIT_paper.pdf
+    // Test against the triangle (0, 1, 3) first; if the hit lies beyond its diagonal, make sure it is also inside the
+    // opposite triangle (2, 3, 1).
+    const glm::vec3 e01 = positions[1] - positions[0];
+    const glm::vec3 e03 = positions[3] - positions[0];
+    const glm::vec3 pvec = glm::cross(rayDir, e03);
+    const float det = glm::dot(e01, pvec);
+    if (det > -SMALL_EPSILON && det < SMALL_EPSILON) {
+        return false;
+    }
+
+    const float invDet = 1.f / det;
+    const glm::vec3 tvec = rayPos - positions[0];
+    const float alpha = glm::dot(tvec, pvec) * invDet;
+    if (alpha < 0.f) {
+        return false;
+    }
+
+    const glm::vec3 qvec = glm::cross(tvec, e01);
+    const float beta = glm::dot(rayDir, qvec) * invDet;
+    if (beta < 0.f) {
+        return false;
+    }
+
+    if (alpha + beta > 1.f) {
+        const glm::vec3 e23 = positions[3] - positions[2];
+        const glm::vec3 e21 = positions[1] - positions[2];
+        const glm::vec3 pvec2 = glm::cross(rayDir, e21);
+        const float det2 = glm::dot(e23, pvec2);
+        if (det2 > -SMALL_EPSILON && det2 < SMALL_EPSILON) {
+            return false;
+        }
+        const float invDet2 = 1.f / det2;
+        const glm::vec3 tvec2 = rayPos - positions[2];
+        const float alpha2 = glm::dot(tvec2, pvec2) * invDet2;
+        if (alpha2 < 0.f) {
+            return false;
+        }
+        const glm::vec3 qvec2 = glm::cross(tvec2, e23);
+        const float beta2 = glm::dot(rayDir, qvec2) * invDet2;
+        if (beta2 < 0.f) {
+            return false;
+        }
+    }
+
+    const float t = glm::dot(e03, qvec) * invDet;
+    if (t - inputRay->GetMaxT() > SMALL_EPSILON || t < -SMALL_EPSILON) {
+        return false;
+    }
+
+    if (outputIntersection && outputIntersection->shadowTransmittance) {
+        outputIntersection->shadowTransmittance->AddHit(this, t, inputRay);
+        return true;
+    }
+
+    if (outputIntersection) {
+        if (t - outputIntersection->intersectionT > SMALL_EPSILON) {
+            return false;
+        }
+
+        // Recover the bilinear coordinates (u, v) of the hit from its barycentric coordinates in triangle (0, 1, 3).
+        float u, v;
+        if (std::abs(alpha11 - 1.f) < LARGE_EPSILON) {
+            u = alpha;
+            v = (std::abs(beta11 - 1.f) < LARGE_EPSILON) ? beta : beta / (u * (beta11 - 1.f) + 1.f);
+        } else if (std::abs(beta11 - 1.f) < LARGE_EPSILON) {
+            v = beta;
+            u = alpha / (v * (alpha11 - 1.f) + 1.f);
+        } else {
+            const float a = -(beta11 - 1.f);
+            const float b = alpha * (beta11 - 1.f) - beta * (alpha11 - 1.f) - 1.f;
+            const float c = alpha;
+            const float discriminant = std::max(b * b - 4.f * a * c, 0.f);
+            const float q = -0.5f * (b + std::copysign(std::sqrt(discriminant), b));
+            u = q / a;
+            if (u < 0.f || u > 1.f) {
+                u = c / q;
+            }
+            v = beta / (u * (beta11 - 1.f) + 1.f);
+        }
+
+        outputIntersection->intersectionRay = *inputRay;
+        outputIntersection->primitiveParent = parentObject;
+        outputIntersection->intersectionT = t;
+        outputIntersection->intersectedPrimitive = this;
+        outputIntersection->intersectedPrimitiveOwner.reset();
+        outputIntersection->hasIntersection = true;
+
+        outputIntersection->primitiveIntersectionWeights.clear();
+        outputIntersection->primitiveIntersectionWeights.emplace_back((1.f - u) * (1.f - v));
+        outputIntersection->primitiveIntersectionWeights.emplace_back(u * (1.f - v));
+        outputIntersection->primitiveIntersectionWeights.emplace_back(u * v);
+        outputIntersection->primitiveIntersectionWeights.emplace_back((1.f - u) * v);
+    }
+
+    return true;
+}
+
+bool Quad::IsPlanarConvexQuad(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3)
+{
+    const std::array<glm::vec3, 4> points = { p0, p1, p2, p3 };
+    const glm::vec3 normal = glm::cross(p2 - p0, p3 - p1);
+    const float normalLength = glm::length(normal);
+    if (normalLength < SMALL_EPSILON) {
+        return false;
+    }
+
+    const glm::vec3 unitNormal = normal / normalLength;
+    const float diagonal = std::max(glm::length(p2 - p0), glm::length(p3 - p1));
+    for (int i = 0; i < 4; ++i) {
+        if (std::abs(glm::dot(points[i] - p0, unitNormal)) > PLANARITY_TOLERANCE * diagonal) {
+            return false;
+        }
+
+        // Every corner has to turn the same way for the quad to be convex.
+        const glm::vec3 incoming = points[i] - points[(i + 3) % 4];
+        const glm::vec3 outgoing = points[(i + 1) % 4] - points[i];
+        if (glm::dot(glm::cross(incoming, outgoing), unitNormal) <= 0.f) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "common/Scene/Geometry/Primitives/Primitive.h"
+
+// Planar, convex quadrilateral with vertices given in order around the face. One quad replaces the two triangles the
+// face would otherwise be split into, which halves both the BVH leaves and the intersection tests on quad-heavy meshes.
+// Vertex attributes are interpolated bilinearly.
+class Quad : public Primitive<4>
+{
+public:
+    Quad(class MeshObject* inputParent);
+    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual glm::vec3 GetPrimitiveNormal() const override;
+    virtual void Finalize() override;
+
+    // Whether the four points form a face this primitive can represent (planar within tolerance and strictly convex).
+    static bool IsPlanarConvexQuad(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3);
+private:
+    // Barycentric coordinates of the third vertex relative to the first, second and fourth; used to recover the bilinear
+    // coordinates of a hit. Computed in Finalize().
+    float alpha11;
+    float beta11;
+};
@@ -0,0 +1,181 @@
+#include "common/Scene/Geometry/Primitives/Sphere/Sphere.h"
+#include "common/Scene/Geometry/Mesh/MeshObject.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Intersection/IntersectionState.h"
+#include "common/Rendering/Material/Material.h"
+#include "common/Rendering/Textures/Texture.h"
+
+Sphere::Sphere(const MeshObject* inputParent, const glm::vec3& inputCenter, float inputRadius) :
+    parentMesh(inputParent), center(inputCenter), radius(inputRadius)
+{
+    assert(radius > 0.f);
+}
+
+bool Sphere::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    DIAGNOSTICS_STAT(DiagnosticsType::SPHERE_INTERSECTIONS);
+    assert(parentObject);
+    // Convert ray into object space. The direction is not normalized so that t stays the same as in world space.
+    const glm::vec3 rayPos = glm::vec3(parentObject->GetWorldToObjectMatrix() * inputRay->GetPosition());
+    const glm::vec3 rayDir = glm::vec3(parentObject->GetWorldToObjectMatrix() * inputRay->GetForwardDirection());
+
+    // Solve |o + t * d - c|^2 = r^2. The discriminant is computed from the distance between the center and the line
+    // rather than b^2 - ac, and the roots with the form that avoids cancellation (Numerical Recipes 5.6), so distant or
+    // grazing rays stay accurate in single precision.
+    const glm::vec3 oc = rayPos - center;
+    const float a = glm::dot(rayDir, rayDir);
+    const float halfB = glm::dot(oc, rayDir);
+    const glm::vec3 perpendicular = oc - (halfB / a) * rayDir;
+    const float discriminant = a * (radius * radius - glm::dot(perpendicular, perpendicular));
+    if (discriminant < 0.f) {
+        return false;
+    }
+
+    const float q = -halfB - std::copysign(std::sqrt(discriminant), halfB);
+    const float c = glm::dot(oc, oc) - radius * radius;
+    float t0 = (q != 0.f) ? c / q : 0.f;
+    float t1 = q / a;
+    if (t0 > t1) {
+        std::swap(t0, t1);
+    }
+
+    // Shadow rays want both crossings of the surface.
+    if (outputIntersection && outputIntersection->shadowTransmittance) {
+        bool hit = false;
+        for (const float rootT : { t0, t1 }) {
+            if (rootT >= -SMALL_EPSILON && rootT - inputRay->GetMaxT() <= SMALL_EPSILON) {
+                outputIntersection->shadowTransmittance->AddHit(this, rootT, inputRay);
+                hit = true;
+            }
+        }
+        return hit;
+    }
+
+    // Take the nearest root in front of the ray; from inside the sphere that is the far one.
+    const float t = (t0 >= -SMALL_EPSILON) ? t0 : t1;
+    if (t - inputRay->GetMaxT() > SMALL_EPSILON || t < -SMALL_EPSILON) {
+        return false;
+    }
+
+    if (outputIntersection) {
+        if (t - outputIntersection->intersectionT > SMALL_EPSILON) {
+            return false;
+        }
+        outputIntersection->intersectionRay = *inputRay;
+        outputIntersection->primitiveParent = parentObject;
+        outputIntersection->intersectionT = t;
+        outputIntersection->intersectedPrimitive = this;
+        outputIntersection->intersectedPrimitiveOwner.reset();
+        outputIntersection->hasIntersection = true;
+        outputIntersection->primitiveIntersectionWeights.clear();
+    }
+
+    return true;
+}
+
+Box Sphere::GetBoundingBox() const
+{
+    return Box(center - glm::vec3(radius), center + glm::vec3(radius));
+}
+
+void Sphere::SetVertexPosition(int index, glm::vec3 position)
+{
+    assert(false && "Spheres have no vertices.");
+}
+
+void Sphere::SetVertexNormal(int index, glm::vec3 normal)
+{
+    assert(false && "Spheres have no vertices.");
+}
+
+void Sphere::SetVertexUV(int index, glm::vec2 uv)
+{
+    assert(false && "Spheres have no vertices.");
+}
+
+void Sphere::SetVertexTangentBitangent(int index, glm::vec3 tangent, glm::vec3 bitangent)
+{
+    assert(false && "Spheres have no vertices.");
+}
+
+void Sphere::Finalize()
+{
+}
+
+glm::vec3 Sphere::GetVertexPosition(int index) const
+{
+    assert(false && "Spheres have no vertices.");
+    return center;
+}
+
+bool Sphere::HasVertexNormals() const
+{
+    return false;
+}
+
+bool Sphere::HasNormalMap() const
+{
+    const Material* material = parentMesh->GetMaterial();
+    return material && material->GetTexture("normalTexture");
+}
+
+glm::vec3 Sphere::GetVertexNormal(int index) const
+{
+    assert(false && "Spheres have no vertices.");
+    return glm::vec3();
+}
+
+glm::vec3 Sphere::GetVertexNormalMap(glm::vec2 uv, const glm::vec3& worldTangent, const glm::vec3& worldBitangent, const glm::vec3& worldNormal) const
+{
+    assert(HasNormalMap());
+    const Material* material = parentMesh->GetMaterial();
+    Texture* normalTexture = material->GetTexture("normalTexture");
+    glm::vec3 normalMap = glm::normalize(glm::vec3(normalTexture->Sample(uv)) * 2.f - 1.f);
+    return glm::mat3(worldTangent, worldBitangent, worldNormal) * normalMap;
+}
+
+glm::vec3 Sphere::GetPrimitiveNormal() const
+{
+    // There is no single face normal; IntersectionState uses ComputeAnalyticFrame instead.
+    assert(false && "Spheres do not have a primitive normal.");
+    return glm::vec3(0.f, 1.f, 0.f);
+}
+
+glm::vec2 Sphere::GetVertexUV(int index) const
+{
+    assert(false && "Spheres have no vertices.");
+    return glm::vec2();
+}
+
+glm::vec3 Sphere::GetVertexTangent(int index) const
+{
+    assert(false && "Spheres have no vertices.");
+    return glm::vec3();
+}
+
+glm::vec3 Sphere::GetVertexBitangent(int index) const
+{
+    assert(false && "Spheres have no vertices.");
+    return glm::vec3();
+}
+
+void Sphere::ComputeAnalyticFrame(const glm::vec3& objectPosition, glm::vec3& normal, glm::vec3& tangent, glm::vec3& bitangent) const
+{
+    normal = glm::normalize(objectPosition - center);
+
+    // The tangent follows increasing u (around the Y axis) and the bitangent increasing v (towards the north pole).
+    const float sinTheta = std::sqrt(normal.x * normal.x + normal.z * normal.z);
+    tangent = (sinTheta > SMALL_EPSILON) ? glm::vec3(-normal.z, 0.f, normal.x) / sinTheta : glm::vec3(1.f, 0.f, 0.f);
+    bitangent = glm::cross(tangent, normal);
+}
+
+glm::vec2 Sphere::ComputeAnalyticUV(const glm::vec3& objectPosition) const
+{
+    const glm::vec3 direction = glm::normalize(objectPosition - center);
+    float u = std::atan2(direction.z, direction.x) / (2.f * PI);
+    if (u < 0.f) {
+        u += 1.f;
+    }
+    const float v = 1.f - std::acos(glm::clamp(direction.y, -1.f, 1.f)) / PI;
+    return glm::vec2(u, v);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common/Scene/Geometry/Primitives/PrimitiveBase.h"
+
+// Exact sphere given by a center and radius in the space of its parent mesh. One ray-sphere test replaces the
+// thousands of triangle tests a tessellated sphere would need, and the normals and UVs are computed analytically.
+class Sphere : public PrimitiveBase
+{
+public:
+    Sphere(const class MeshObject* inputParent, const glm::vec3& inputCenter, float inputRadius);
+
+    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual Box GetBoundingBox() const override;
+
+    virtual const class MeshObject* GetParentMeshObject() const override
+    {
+        return parentMesh;
+    }
+
+    // Spheres have no vertices.
+    virtual void SetVertexPosition(int index, glm::vec3 position) override;
+    virtual void SetVertexNormal(int index, glm::vec3 normal) override;
+    virtual void SetVertexUV(int index, glm::vec2 uv) override;
+    virtual void SetVertexTangentBitangent(int index, glm::vec3 tangent, glm::vec3 bitangent) override;
+
+    virtual int GetTotalVertices() const override
+    {
+        return 0;
+    }
+
+    virtual void Finalize() override;
+
+    virtual glm::vec3 GetVertexPosition(int index) const override;
+    virtual bool HasVertexNormals() const override;
+    virtual bool HasNormalMap() const override;
+    virtual glm::vec3 GetVertexNormal(int index) const override;
+    virtual glm::vec3 GetVertexNormalMap(glm::vec2 uv, const glm::vec3& worldTangent, const glm::vec3& worldBitangent, const glm::vec3& worldNormal) const override;
+    virtual glm::vec3 GetPrimitiveNormal() const override;
+    virtual glm::vec2 GetVertexUV(int index) const override;
+    virtual glm::vec3 GetVertexTangent(int index) const override;
+    virtual glm::vec3 GetVertexBitangent(int index) const override;
+
+    virtual bool IsAnalytic() const override
+    {
+        return true;
+    }
+
+    virtual void ComputeAnalyticFrame(const glm::vec3& objectPosition, glm::vec3& normal, glm::vec3& tangent, glm::vec3& bitangent) const override;
+    virtual glm::vec2 ComputeAnalyticUV(const glm::vec3& objectPosition) const override;
+
+    glm::vec3 GetCenter() const { return center; }
+    float GetRadius() const { return radius; }
+private:
+    const class MeshObject* parentMesh;
+    glm::vec3 center;
+    float radius;
+};
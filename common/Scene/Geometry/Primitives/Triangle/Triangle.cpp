@@ -9,12 +9,23 @@ Triangle::Triangle(class MeshObject* inputParent):
 
 glm::vec3 Triangle::GetPrimitiveNormal() const
 {
-    const glm::vec3 edge1 = glm::normalize(positions[1] - positions[0]);
-    const glm::vec3 edge2 = glm::normalize(positions[2] - positions[0]);
+    return ComputeTriangleNormal(positions[0], positions[1], positions[2]);
+}
+
+glm::vec3 Triangle::ComputeTriangleNormal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+{
+    const glm::vec3 edge1 = glm::normalize(p1 - p0);
+    const glm::vec3 edge2 = glm::normalize(p2 - p0);
     return glm::normalize(glm::cross(edge1, edge2));
 }
 
 bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    return TraceTriangle(this, positions[0], positions[1], positions[2], parentObject, inputRay, outputIntersection);
+}
+
+bool Triangle::TraceTriangle(const PrimitiveBase* primitive, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2,
+    const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection)
 {
     DIAGNOSTICS_STAT(DiagnosticsType::TRIANGLE_INTERSECTIONS);
     assert(parentObject);
@@ -24,8 +35,8 @@ bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, Intersectio
 
     // Use Moller-Trumbore Intersection (Fast, Minimum Storage Ray/Triangle Intersection)
     // Paper: http://www.cs.virginia.edu/~gfx/Courses/2003/ImageSynthesis/papers/Acceleration/Fast%20MinimumStorage%20RayTriangle%20Intersection.pdf
-    const glm::vec3 edge1 = positions[1] - positions[0];
-    const glm::vec3 edge2 = positions[2] - positions[0];
+    const glm::vec3 edge1 = p1 - p0;
+    const glm::vec3 edge2 = p2 - p0;
     const glm::vec3 pvec = glm::cross(rayDir, edge2);
 
     float det = glm::dot(edge1, pvec);
@@ -36,7 +47,7 @@ bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, Intersectio
 
     const float invDet = 1.f / det;
 
-    const glm::vec3 tvec = glm::vec3(rayPos) - positions[0];
+    const glm::vec3 tvec = glm::vec3(rayPos) - p0;
     const float u = glm::dot(tvec, pvec) * invDet;
     if (u < 0.f || u > 1.f) {
         return false;
@@ -53,6 +64,11 @@ bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, Intersectio
         return false;
     }
 
+    if (outputIntersection && outputIntersection->shadowTransmittance) {
+        outputIntersection->shadowTransmittance->AddHit(primitive, t, inputRay);
+        return true;
+    }
+
     if (outputIntersection) {
         if (t - outputIntersection->intersectionT > SMALL_EPSILON) {
             return false;
@@ -60,7 +76,8 @@ bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, Intersectio
         outputIntersection->intersectionRay = *inputRay;
         outputIntersection->primitiveParent = parentObject;
         outputIntersection->intersectionT = t;
-        outputIntersection->intersectedPrimitive = this;
+        outputIntersection->intersectedPrimitive = primitive;
+        outputIntersection->intersectedPrimitiveOwner.reset();
         outputIntersection->hasIntersection = true;
 
         outputIntersection->primitiveIntersectionWeights.clear();
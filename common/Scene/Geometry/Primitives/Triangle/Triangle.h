@@ -8,4 +8,12 @@ public:
     Triangle(class MeshObject* inputParent);
     virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
     virtual glm::vec3 GetPrimitiveNormal() const override;
+
+    // Ray-triangle test shared with the other triangle representations. On a closer hit, fills in outputIntersection
+    // with the given primitive.
+    static bool TraceTriangle(const PrimitiveBase* primitive, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2,
+        const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection);
+
+    // Face normal shared with the other triangle representations.
+    static glm::vec3 ComputeTriangleNormal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2);
 };
\ No newline at end of file
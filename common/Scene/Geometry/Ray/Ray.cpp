@@ -1,13 +1,13 @@
 #include "common/Scene/Geometry/Ray/Ray.h"
 
 Ray::Ray() :
-    rayDirection(glm::vec3(0.f, 0.f, -1.f)), maxT(std::numeric_limits<float>::max())
+    rayDirection(glm::vec3(0.f, 0.f, -1.f)), maxT(std::numeric_limits<float>::max()), totalMaskedObjects(0)
 {
     position = glm::vec4(0.f, 0.f, 0.f, 1.f);
 }
 
 Ray::Ray(glm::vec3 inputPosition, glm::vec3 inputDirection, float inputMaxT):
-    rayDirection(glm::normalize(inputDirection)), maxT(inputMaxT)
+    rayDirection(glm::normalize(inputDirection)), maxT(inputMaxT), totalMaskedObjects(0)
 {
     position = glm::vec4(inputPosition, 1.f);
 }
@@ -39,12 +39,19 @@ glm::vec3 Ray::GetRayPosition(float t) const
 
 void Ray::SetRayMask(uint64_t objectId)
 {
-    traceMask[objectId] = true;
+    if (totalMaskedObjects < MAX_MASKED_OBJECTS && !IsObjectMasked(objectId)) {
+        traceMask[totalMaskedObjects++] = objectId;
+    }
 }
 
 bool Ray::IsObjectMasked(uint64_t objectId)
 {
-    return traceMask[objectId];
+    for (int i = 0; i < totalMaskedObjects; ++i) {
+        if (traceMask[i] == objectId) {
+            return true;
+        }
+    }
+    return false;
 }
 
 glm::vec3 Ray::RefractRay(const glm::vec3& normal, float n1, float& n2) const
@@ -27,5 +27,9 @@ private:
     glm::vec3 rayDirection;
     float maxT;
 
-    std::unordered_map<uint64_t, bool> traceMask;
+    // Objects this ray is known to miss (see SceneObject::Trace). The mask only saves work, so ids that do not fit are
+    // simply not recorded; keeping it inline means creating and copying rays never allocates.
+    static const int MAX_MASKED_OBJECTS = 8;
+    std::array<uint64_t, MAX_MASKED_OBJECTS> traceMask;
+    int totalMaskedObjects;
 };
\ No newline at end of file
@@ -1,24 +1,39 @@
 #include "common/Scene/Lights/Area/AreaLight.h"
+#include "common/Utility/Random/Random.h"
+
+namespace
+{
+
+const uint64_t SAMPLE_PATTERN_KEY = 0x4172656150617474ULL;
+
+}
 
 AreaLight::AreaLight(const glm::vec2& size):
-    samplesToUse(4), lightSize(size)
+    gridSize(2, 2, 1), samplesToUse(4), lightSize(size)
 {
-    sampler = make_unique<JitterColorSampler>();
-    sampler->SetGridSize(glm::ivec3(2, 2, 1));
+    GenerateSamplePatterns();
 }
 
 void AreaLight::ComputeSampleRays(std::vector<Ray>& output, glm::vec3 origin, glm::vec3 normal) const
 {
     origin += normal * LARGE_EPSILON;
-    std::random_device rd;
-    std::unique_ptr<SamplerState> sampleState = sampler->CreateSampler(rd, samplesToUse, 2);
+
+    Random::Generator& generator = Random::GetThreadGenerator();
+    const glm::vec2 rotation(generator.NextFloat(), generator.NextFloat());
+    const glm::vec2* pattern = &samplePatterns[(generator.NextUInt() % TOTAL_SAMPLE_PATTERNS) * samplesToUse];
+
+    // The light is a rectangle in its local XY plane, centered on its position.
+    const glm::mat4 objectToWorld = GetObjectToWorldMatrix();
+    const glm::vec3 corner = glm::vec3(objectToWorld * glm::vec4(-0.5f * lightSize, 0.f, 1.f));
+    const glm::vec3 edgeX = glm::vec3(objectToWorld[0]) * lightSize.x;
+    const glm::vec3 edgeY = glm::vec3(objectToWorld[1]) * lightSize.y;
+
+    output.reserve(output.size() + samplesToUse);
     for (int i = 0; i < samplesToUse; ++i) {
-        glm::vec3 sample = sampler->ComputeSampleCoordinate(*sampleState.get()) - 0.5f;
-        sample.x *= lightSize.x;
-        sample.y *= lightSize.y;
-        sample.z = 0.f;
+        glm::vec2 sample = pattern[i] + rotation;
+        sample -= glm::floor(sample);
 
-        const glm::vec3 lightPosition = glm::vec3(GetObjectToWorldMatrix() * glm::vec4(sample, 1.f));
+        const glm::vec3 lightPosition = corner + edgeX * sample.x + edgeY * sample.y;
         const glm::vec3 rayDirection = glm::normalize(lightPosition - origin);
         const float distanceToOrigin = glm::distance(origin, lightPosition);
         output.emplace_back(origin, rayDirection, distanceToOrigin);
@@ -37,27 +52,64 @@ float AreaLight::ComputeLightAttenuation(glm::vec3 origin) const
 
 void AreaLight::GenerateRandomPhotonRay(Ray& ray) const
 {
-    std::random_device rd;
-    std::unique_ptr<SamplerState> sampleState = sampler->CreateSampler(rd, 1, 2);
-    glm::vec3 sample = sampler->ComputeSampleCoordinate(*sampleState.get()) - 0.5f;
+    // A single point per photon has nothing to stratify against, so it is drawn directly.
+    Random::Generator& generator = Random::GetThreadGenerator();
+    glm::vec3 sample(generator.NextFloat() - 0.5f, generator.NextFloat() - 0.5f, 0.f);
     sample.x *= lightSize.x;
     sample.y *= lightSize.y;
-    sample.z = 0.f;
     const glm::vec3 lightPosition = glm::vec3(GetObjectToWorldMatrix() * glm::vec4(sample, 1.f));
     ray.SetRayPosition(lightPosition);
     
     float x,y,z;
     do {
-        x=std::rand()*2.f/RAND_MAX-1.f;
-        y=std::rand()*2.f/RAND_MAX-1.f;
-        z=std::rand()*2.f/RAND_MAX-1.f;       
+        x=generator.NextFloat()*2.f-1.f;
+        y=generator.NextFloat()*2.f-1.f;
+        z=generator.NextFloat()*2.f-1.f;
     } while ((x*x+y*y+z*z)>1.f);
     const glm::vec3 rayDirection = glm::normalize(glm::vec3(x,y,z));
     ray.SetRayDirection(rayDirection);
 }
 
+bool AreaLight::ComputeLightBounds(LightBounds& output) const
+{
+    // One-sided: points behind the light get nothing (see ComputeLightAttenuation).
+    const glm::mat4 objectToWorld = GetObjectToWorldMatrix();
+    output.bounds.Reset();
+    for (int i = 0; i < 4; ++i) {
+        const glm::vec2 corner((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f);
+        const glm::vec3 worldCorner = glm::vec3(objectToWorld * glm::vec4(corner * lightSize, 0.f, 1.f));
+        output.bounds.IncludeBox(Box(worldCorner, worldCorner));
+    }
+    output.axis = glm::vec3(GetForwardDirection());
+    output.normalAngle = 0.f;
+    output.emissionAngle = PI / 2.f;
+    output.power = glm::dot(lightColor, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    return true;
+}
+
 void AreaLight::SetSamplerAttributes(glm::ivec3 inputGridSize, int numSamples)
 {
-    sampler->SetGridSize(inputGridSize);
+    assert(inputGridSize.x * inputGridSize.y > 0 && numSamples > 0);
+    gridSize = inputGridSize;
     samplesToUse = numSamples;
+    GenerateSamplePatterns();
+}
+
+void AreaLight::GenerateSamplePatterns()
+{
+    // Light samples are two dimensional; the z extent of the grid is ignored.
+    const int totalCells = gridSize.x * gridSize.y;
+    const glm::vec2 cellSize = glm::vec2(1.f) / glm::vec2(gridSize.x, gridSize.y);
+    samplePatterns.resize(static_cast<size_t>(TOTAL_SAMPLE_PATTERNS) * samplesToUse);
+    for (int p = 0; p < TOTAL_SAMPLE_PATTERNS; ++p) {
+        Random::Generator generator(Random::MakeKey(SAMPLE_PATTERN_KEY, static_cast<uint64_t>(p)));
+        const uint32_t cellSeed = generator.NextUInt();
+        for (int i = 0; i < samplesToUse; ++i) {
+            // Every pattern visits the cells in its own order, so fewer samples than cells do not always leave the
+            // same cells empty.
+            const int cell = static_cast<int>(Random::PermuteIndex(static_cast<uint32_t>(i % totalCells), static_cast<uint32_t>(totalCells), cellSeed));
+            const glm::vec2 jitter(generator.NextFloat(), generator.NextFloat());
+            samplePatterns[static_cast<size_t>(p) * samplesToUse + i] = (glm::vec2(cell % gridSize.x, cell / gridSize.x) + jitter) * cellSize;
+        }
+    }
 }
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "common/Scene/Lights/Light.h"
-#include "common/Sampling/Jitter/JitterColorSampler.h"
 
 class AreaLight : public Light
 {
@@ -13,10 +12,20 @@ public:
 
     virtual void GenerateRandomPhotonRay(Ray& ray) const override;
 
+    virtual bool ComputeLightBounds(LightBounds& output) const override;
+
     // Sampler Attributes
     void SetSamplerAttributes(glm::ivec3 inputGridSize, int numSamples);
 private:
-    std::unique_ptr<JitterColorSampler> sampler;
+    void GenerateSamplePatterns();
+
+    // Stratified sets of samplesToUse points on [0, 1)^2, generated once. Every shading point picks one of them and
+    // rotates it by a random offset (Cranley-Patterson), which keeps the stratification and makes every point uniform
+    // over the light.
+    static const int TOTAL_SAMPLE_PATTERNS = 64;
+    std::vector<glm::vec2> samplePatterns;
+
+    glm::ivec3 gridSize;
     int samplesToUse;
     glm::vec2 lightSize;
-};
\ No newline at end of file
+};
@@ -1,4 +1,5 @@
 #include "common/Scene/Lights/Directional/DirectionalLight.h"
+#include "common/Utility/Random/Random.h"
 
 void DirectionalLight::ComputeSampleRays(std::vector<Ray>& output, glm::vec3 origin, glm::vec3 normal) const
 {
@@ -13,13 +14,19 @@ float DirectionalLight::ComputeLightAttenuation(glm::vec3 origin) const
 
 void DirectionalLight::GenerateRandomPhotonRay(Ray& ray) const
 {
+    Random::Generator& generator = Random::GetThreadGenerator();
     float d=2.0f;
     glm::vec3 sample;
-    sample.x=(std::rand()*1.f/RAND_MAX-.5f)*d;
-    sample.y=(std::rand()*1.f/RAND_MAX-.5f)*d;
+    sample.x=(generator.NextFloat()-.5f)*d;
+    sample.y=(generator.NextFloat()-.5f)*d;
     sample.z=4.f;
     glm::vec3 lightPosition = glm::vec3(GetObjectToWorldMatrix() * glm::vec4(sample,1.f));
     ray.SetRayPosition(lightPosition); 
     
     ray.SetRayDirection(glm::vec3(GetForwardDirection()));
 }
+
+bool DirectionalLight::ComputeLightBounds(LightBounds& output) const
+{
+    return false;
+}
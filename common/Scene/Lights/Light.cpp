@@ -8,4 +8,15 @@ glm::vec3 Light::GetLightColor() const
 void Light::SetLightColor(glm::vec3 input)
 {
     lightColor = input;
+}
+
+bool Light::ComputeLightBounds(LightBounds& output) const
+{
+    const glm::vec3 position = glm::vec3(GetPosition());
+    output.bounds = Box(position, position);
+    output.axis = glm::vec3(GetForwardDirection());
+    output.normalAngle = PI;
+    output.emissionAngle = PI / 2.f;
+    output.power = glm::dot(lightColor, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    return true;
 }
\ No newline at end of file
@@ -2,6 +2,18 @@
 
 #include "common/Scene/SceneObject.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Scene/Geometry/Simple/Box/Box.h"
+
+// Where a light (or a group of lights) is and in which directions it emits, for choosing lights to sample (see
+// LightBVH). The emitter normals lie within normalAngle of axis and light leaves within emissionAngle of a normal.
+struct LightBounds
+{
+    Box bounds;
+    glm::vec3 axis;
+    float normalAngle;
+    float emissionAngle;
+    float power;
+};
 
 class Light : public SceneObject
 {
@@ -15,6 +27,11 @@ public:
     // Photon Mapping Utility Functions
     virtual void GenerateRandomPhotonRay(Ray& ray) const = 0;
 
+    // Light Selection Utility Functions
+    // Returns false for lights that reach everything (e.g. directional lights); those are never left out. The default
+    // is a point at the light's position emitting in all directions.
+    virtual bool ComputeLightBounds(LightBounds& output) const;
+
 protected:
     glm::vec3 lightColor;
 };
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "common/Scene/Lights/Point/PointLight.h"
+#include "common/Utility/Random/Random.h"
 
 
 void PointLight::ComputeSampleRays(std::vector<Ray>& output, glm::vec3 origin, glm::vec3 normal) const
@@ -21,11 +22,12 @@ void PointLight::GenerateRandomPhotonRay(Ray& ray) const
     const glm::vec3 lightPosition = glm::vec3(GetPosition());
     ray.SetRayPosition(lightPosition); 
     
+    Random::Generator& generator = Random::GetThreadGenerator();
     float x,y,z;
     do {
-        x=std::rand()*2.f/RAND_MAX-1.f;
-        y=std::rand()*2.f/RAND_MAX-1.f;
-        z=std::rand()*2.f/RAND_MAX-1.f;       
+        x=generator.NextFloat()*2.f-1.f;
+        y=generator.NextFloat()*2.f-1.f;
+        z=generator.NextFloat()*2.f-1.f;
     } while ((x*x+y*y+z*z)>1.f);
     const glm::vec3 rayDirection = glm::normalize(glm::vec3(x,y,z));
     ray.SetRayDirection(rayDirection);
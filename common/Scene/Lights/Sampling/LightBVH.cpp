@@ -0,0 +1,180 @@
+#include "common/Scene/Lights/Sampling/LightBVH.h"
+#include "common/Scene/Scene.h"
+
+namespace
+{
+
+// The Blinn-Phong highlight does not fall off with N.L, so lights below the horizon of a surface can still show up in
+// it. They keep this fraction of their weight instead of never being picked.
+const float BELOW_HORIZON_IMPORTANCE = 0.05f;
+
+float AngleBetween(const glm::vec3& a, const glm::vec3& b)
+{
+    return std::acos(glm::clamp(glm::dot(a, b), -1.f, 1.f));
+}
+
+// Smallest cone (approximately) containing both cones of normals.
+void MergeNormalCones(const LightBounds& first, const LightBounds& second, LightBounds& output)
+{
+    const LightBounds& wider = (first.normalAngle >= second.normalAngle) ? first : second;
+    const LightBounds& narrower = (first.normalAngle >= second.normalAngle) ? second : first;
+
+    const float axisAngle = AngleBetween(wider.axis, narrower.axis);
+    if (std::min(axisAngle + narrower.normalAngle, PI) <= wider.normalAngle) {
+        output.axis = wider.axis;
+        output.normalAngle = wider.normalAngle;
+        return;
+    }
+
+    const float mergedAngle = 0.5f * (wider.normalAngle + axisAngle + narrower.normalAngle);
+    if (mergedAngle >= PI) {
+        output.axis = wider.axis;
+        output.normalAngle = PI;
+        return;
+    }
+
+    // Rotate the wider axis towards the narrower one until the merged cone touches both.
+    const glm::vec3 orthogonal = narrower.axis - wider.axis * glm::dot(wider.axis, narrower.axis);
+    const float orthogonalLength = glm::length(orthogonal);
+    if (orthogonalLength < SMALL_EPSILON) {
+        output.axis = wider.axis;
+        output.normalAngle = PI;
+        return;
+    }
+    const float rotation = mergedAngle - wider.normalAngle;
+    output.axis = glm::normalize(wider.axis * std::cos(rotation) + (orthogonal / orthogonalLength) * std::sin(rotation));
+    output.normalAngle = mergedAngle;
+}
+
+}
+
+LightBVH::LightBVH()
+{
+}
+
+void LightBVH::Build(const Scene& scene)
+{
+    nodes.clear();
+    boundedLights.clear();
+    unboundedLights.clear();
+
+    std::vector<std::pair<LightBounds, int>> lights;
+    for (size_t i = 0; i < scene.GetTotalLights(); ++i) {
+        const Light* light = scene.GetLightObject(i);
+        LightBounds bounds;
+        if (!light->ComputeLightBounds(bounds)) {
+            unboundedLights.push_back(light);
+            continue;
+        }
+        lights.emplace_back(bounds, static_cast<int>(boundedLights.size()));
+        boundedLights.push_back(light);
+    }
+
+    if (!lights.empty()) {
+        nodes.reserve(2 * lights.size() - 1);
+        BuildNode(lights, 0, lights.size());
+    }
+}
+
+int LightBVH::BuildNode(std::vector<std::pair<LightBounds, int>>& lights, size_t begin, size_t end)
+{
+    const int nodeIndex = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+    if (end - begin == 1) {
+        nodes[nodeIndex].bounds = lights[begin].first;
+        nodes[nodeIndex].lightIndex = lights[begin].second;
+        nodes[nodeIndex].secondChild = -1;
+        return nodeIndex;
+    }
+
+    // Split at the median along the longest extent of the light centers.
+    Box centerBounds;
+    for (size_t i = begin; i < end; ++i) {
+        const glm::vec3 center = lights[i].first.bounds.Center();
+        centerBounds.IncludeBox(Box(center, center));
+    }
+    const glm::vec3 extent = centerBounds.maxVertex - centerBounds.minVertex;
+    const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+    const size_t middle = begin + (end - begin) / 2;
+    std::nth_element(lights.begin() + begin, lights.begin() + middle, lights.begin() + end,
+        [axis](const std::pair<LightBounds, int>& a, const std::pair<LightBounds, int>& b) {
+            return a.first.bounds.Center()[axis] < b.first.bounds.Center()[axis];
+        });
+
+    BuildNode(lights, begin, middle);
+    const int secondChild = BuildNode(lights, middle, end);
+
+    const LightBounds& first = nodes[nodeIndex + 1].bounds;
+    const LightBounds& second = nodes[secondChild].bounds;
+    LightBounds merged;
+    merged.bounds = first.bounds;
+    merged.bounds.IncludeBox(second.bounds);
+    MergeNormalCones(first, second, merged);
+    merged.emissionAngle = std::max(first.emissionAngle, second.emissionAngle);
+    merged.power = first.power + second.power;
+
+    nodes[nodeIndex].bounds = merged;
+    nodes[nodeIndex].lightIndex = -1;
+    nodes[nodeIndex].secondChild = secondChild;
+    return nodeIndex;
+}
+
+float LightBVH::ComputeImportance(const LightBounds& bounds, const glm::vec3& position, const glm::vec3& normal) const
+{
+    // Lights here do not fall off with distance, so distance only matters through the angles the bounds span.
+    const glm::vec3 toCenter = bounds.bounds.Center() - position;
+    const float distance = glm::length(toCenter);
+    const float radius = 0.5f * glm::length(bounds.bounds.maxVertex - bounds.bounds.minVertex);
+    if (distance <= radius) {
+        return bounds.power;
+    }
+    const glm::vec3 toLight = toCenter / distance;
+    const float boundsAngle = std::asin(radius / distance);
+
+    // Can any light in the node emit towards the point?
+    const float emitterAngle = std::max(AngleBetween(bounds.axis, -toLight) - bounds.normalAngle - boundsAngle, 0.f);
+    if (emitterAngle >= bounds.emissionAngle) {
+        return 0.f;
+    }
+
+    const float receiverAngle = std::max(AngleBetween(normal, toLight) - boundsAngle, 0.f);
+    const float receiverCosine = (receiverAngle < PI / 2.f) ? std::cos(receiverAngle) : 0.f;
+    return bounds.power * std::max(receiverCosine, BELOW_HORIZON_IMPORTANCE);
+}
+
+const Light* LightBVH::SampleLight(const glm::vec3& position, const glm::vec3& normal, float u, float& pdf) const
+{
+    if (nodes.empty()) {
+        return nullptr;
+    }
+
+    pdf = 1.f;
+    int nodeIndex = 0;
+    while (nodes[nodeIndex].lightIndex < 0) {
+        const int firstChild = nodeIndex + 1;
+        const int secondChild = nodes[nodeIndex].secondChild;
+        const float firstImportance = ComputeImportance(nodes[firstChild].bounds, position, normal);
+        const float secondImportance = ComputeImportance(nodes[secondChild].bounds, position, normal);
+        if (firstImportance + secondImportance <= 0.f) {
+            return nullptr;
+        }
+
+        // Reuse u for the next level by stretching the part of [0, 1) that chose the child.
+        const float firstProbability = firstImportance / (firstImportance + secondImportance);
+        if (u < firstProbability) {
+            u = std::min(u / firstProbability, 1.f - SMALL_EPSILON);
+            pdf *= firstProbability;
+            nodeIndex = firstChild;
+        } else {
+            u = std::min((u - firstProbability) / (1.f - firstProbability), 1.f - SMALL_EPSILON);
+            pdf *= 1.f - firstProbability;
+            nodeIndex = secondChild;
+        }
+    }
+
+    // A single light that cannot reach the point (the root is a leaf).
+    if (ComputeImportance(nodes[nodeIndex].bounds, position, normal) <= 0.f) {
+        return nullptr;
+    }
+    return boundedLights[nodes[nodeIndex].lightIndex];
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "common/Scene/Lights/Light.h"
+
+// Picks lights for a shading point with probability roughly proportional to what they can contribute there (Conty and
+// Kulla, "Importance Sampling of Many Lights with Adaptive Tree Splitting"). Every node bounds the position, power
+// and emission directions of its lights; sampling walks down from the root and chooses between the two children by
+// their estimated contribution. Lights without bounds (see Light::ComputeLightBounds) are kept aside and should be
+// evaluated at every shading point.
+class LightBVH
+{
+public:
+    LightBVH();
+
+    void Build(const class Scene& scene);
+
+    // Chooses one bounded light for a point with surface normal 'normal', using u in [0, 1) as the random number.
+    // Returns nullptr if no light can reach the point; otherwise pdf is the probability the light was chosen with.
+    const Light* SampleLight(const glm::vec3& position, const glm::vec3& normal, float u, float& pdf) const;
+
+    const std::vector<const Light*>& GetUnboundedLights() const
+    {
+        return unboundedLights;
+    }
+
+    size_t GetTotalBoundedLights() const
+    {
+        return boundedLights.size();
+    }
+
+private:
+    struct LightNode
+    {
+        LightBounds bounds;
+        // Leaves hold a light, inner nodes their second child (the first one follows the node).
+        int lightIndex;
+        int secondChild;
+    };
+
+    int BuildNode(std::vector<std::pair<LightBounds, int>>& lights, size_t begin, size_t end);
+    float ComputeImportance(const LightBounds& bounds, const glm::vec3& position, const glm::vec3& normal) const;
+
+    std::vector<LightNode> nodes;
+    std::vector<const Light*> boundedLights;
+    std::vector<const Light*> unboundedLights;
+};
@@ -4,6 +4,29 @@
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Rendering/Material/Material.h"
 #include "common/Acceleration/AccelerationCommon.h"
+#include "common/Intersection/IntersectionStateArena.h"
+#include "common/Utility/Random/Random.h"
+#include "common/Utility/Hash/Hash.h"
+#include "common/Scene/SceneObject.h"
+#include "common/Scene/Lights/Light.h"
+#include <cstring>
+#include <typeinfo>
+
+namespace
+{
+
+template<typename T>
+uint64_t HashVector(const T& value, uint64_t seed)
+{
+    return Hash::HashBytes(glm::value_ptr(value), sizeof(T), seed);
+}
+
+}
+
+Scene::Scene() :
+    minimumRayContribution(0.f), russianRoulette(false)
+{
+}
 
 void Scene::GenerateDefaultAccelerationData()
 {
@@ -29,40 +52,129 @@ bool Scene::Trace(class Ray* inputRay, IntersectionState* outputIntersection) co
 {
     assert(inputRay);
     DIAGNOSTICS_STAT(DiagnosticsType::RAYS_CREATED);
+    return acceleration->Trace(nullptr, inputRay, outputIntersection);
+}
 
-    bool didIntersect = acceleration->Trace(nullptr, inputRay, outputIntersection);
-    if (outputIntersection != nullptr && didIntersect) {
-        const MeshObject* intersectedMesh = outputIntersection->intersectedPrimitive->GetParentMeshObject();
-        assert(intersectedMesh);
-        const Material* currentMaterial = intersectedMesh->GetMaterial();
-        assert(currentMaterial);
-
-        const glm::vec3 intersectionPoint = outputIntersection->intersectionRay.GetRayPosition(outputIntersection->intersectionT);
-        const float NdR = glm::dot(inputRay->GetRayDirection(), outputIntersection->ComputeNormal());
-        // send out reflection ray.
-        if (currentMaterial->IsReflective() && outputIntersection->remainingReflectionBounces > 0) {
-            outputIntersection->reflectionIntersection = std::make_shared<IntersectionState>(outputIntersection->remainingReflectionBounces - 1, outputIntersection->remainingRefractionBounces);
-
-            Ray reflectionRay;
-            PerformRaySpecularReflection(reflectionRay, *inputRay, intersectionPoint, NdR, *outputIntersection);
-            Trace(&reflectionRay, outputIntersection->reflectionIntersection.get());
-        }
+glm::vec3 Scene::ComputeShadowTransmittance(class Ray* inputRay) const
+{
+    assert(inputRay);
+    DIAGNOSTICS_STAT(DiagnosticsType::RAYS_CREATED);
+    ShadowTransmittance shadow;
+    IntersectionState shadowState;
+    shadowState.shadowTransmittance = &shadow;
+    acceleration->Trace(nullptr, inputRay, &shadowState);
+    return shadow.GetTransmittance();
+}
 
-        // send out refraction ray.
-        if (currentMaterial->IsTransmissive() && outputIntersection->remainingRefractionBounces > 0) {
-            outputIntersection->refractionIntersection = std::make_shared<IntersectionState>(outputIntersection->remainingReflectionBounces, outputIntersection->remainingRefractionBounces - 1);
+const IntersectionState* Scene::TraceReflection(const IntersectionState& intersection) const
+{
+    if (intersection.reflectionIntersection) {
+        return intersection.reflectionIntersection;
+    }
+
+    if (!intersection.hasIntersection || intersection.remainingReflectionBounces <= 0) {
+        return nullptr;
+    }
+
+    const Material* currentMaterial = GetIntersectedMaterial(intersection);
+    if (!currentMaterial->IsReflective()) {
+        return nullptr;
+    }
+
+    const glm::vec3 throughput = intersection.pathThroughput * currentMaterial->GetBaseSpecularReflection();
+    float russianRouletteWeight = 1.f;
+    if (!ShouldTraceSecondaryRay(throughput, russianRouletteWeight)) {
+        return nullptr;
+    }
 
-            // If we're going into the mesh, set the target IOR to be the IOR of the mesh.
-            float targetIOR = (NdR < SMALL_EPSILON) ? currentMaterial->GetIOR() : 1.f;
+    const Ray& inputRay = intersection.intersectionRay;
+    const glm::vec3 intersectionPoint = intersection.ComputePosition();
+    const float NdR = glm::dot(inputRay.GetRayDirection(), intersection.ComputeNormal());
+
+    IntersectionState* reflectionIntersection = IntersectionStateArena::GetThreadArena().Allocate(intersection.remainingReflectionBounces - 1, intersection.remainingRefractionBounces);
+    reflectionIntersection->pathThroughput = throughput * russianRouletteWeight;
+    reflectionIntersection->russianRouletteWeight = russianRouletteWeight;
+    Ray reflectionRay;
+    PerformRaySpecularReflection(reflectionRay, inputRay, intersectionPoint, NdR, intersection);
+    Trace(&reflectionRay, reflectionIntersection);
+
+    intersection.reflectionIntersection = reflectionIntersection;
+    return reflectionIntersection;
+}
+
+const IntersectionState* Scene::TraceRefraction(const IntersectionState& intersection) const
+{
+    if (intersection.refractionIntersection) {
+        return intersection.refractionIntersection;
+    }
+
+    if (!intersection.hasIntersection || intersection.remainingRefractionBounces <= 0) {
+        return nullptr;
+    }
 
-            Ray refractionRay;
-            PerformRayRefraction(refractionRay, *inputRay, intersectionPoint, NdR, *outputIntersection, targetIOR);
-            outputIntersection->refractionIntersection->currentIOR = targetIOR;
-            Trace(&refractionRay, outputIntersection->refractionIntersection.get());
+    const Material* currentMaterial = GetIntersectedMaterial(intersection);
+    if (!currentMaterial->IsTransmissive()) {
+        return nullptr;
+    }
+
+    const glm::vec3 throughput = intersection.pathThroughput * currentMaterial->GetBaseTransmittance();
+    float russianRouletteWeight = 1.f;
+    if (!ShouldTraceSecondaryRay(throughput, russianRouletteWeight)) {
+        return nullptr;
+    }
+
+    const Ray& inputRay = intersection.intersectionRay;
+    const glm::vec3 intersectionPoint = intersection.ComputePosition();
+    const float NdR = glm::dot(inputRay.GetRayDirection(), intersection.ComputeNormal());
+
+    // If we're going into the mesh, set the target IOR to be the IOR of the mesh.
+    float targetIOR = (NdR < SMALL_EPSILON) ? currentMaterial->GetIOR() : 1.f;
+
+    IntersectionState* refractionIntersection = IntersectionStateArena::GetThreadArena().Allocate(intersection.remainingReflectionBounces, intersection.remainingRefractionBounces - 1);
+    Ray refractionRay;
+    PerformRayRefraction(refractionRay, inputRay, intersectionPoint, NdR, intersection, targetIOR);
+    refractionIntersection->currentIOR = targetIOR;
+    refractionIntersection->pathThroughput = throughput * russianRouletteWeight;
+    refractionIntersection->russianRouletteWeight = russianRouletteWeight;
+    Trace(&refractionRay, refractionIntersection);
+
+    intersection.refractionIntersection = refractionIntersection;
+    return refractionIntersection;
+}
+
+void Scene::SetSecondaryRayCulling(float minimumContribution, bool useRussianRoulette)
+{
+    minimumRayContribution = std::max(minimumContribution, 0.f);
+    russianRoulette = useRussianRoulette;
+}
+
+bool Scene::ShouldTraceSecondaryRay(const glm::vec3& throughput, float& russianRouletteWeight) const
+{
+    russianRouletteWeight = 1.f;
+    const float contribution = std::max(throughput.x, std::max(throughput.y, throughput.z));
+    if (contribution >= minimumRayContribution) {
+        return true;
+    }
+
+    if (russianRoulette && contribution > 0.f) {
+        const float survivalProbability = contribution / minimumRayContribution;
+        if (Random::GetThreadGenerator().NextFloat() < survivalProbability) {
+            russianRouletteWeight = 1.f / survivalProbability;
+            return true;
         }
     }
 
-    return didIntersect;
+    DIAGNOSTICS_STAT(DiagnosticsType::SECONDARY_RAYS_SKIPPED);
+    return false;
+}
+
+const Material* Scene::GetIntersectedMaterial(const IntersectionState& intersection) const
+{
+    const MeshObject* intersectedMesh = intersection.intersectedPrimitive->GetParentMeshObject();
+    assert(intersectedMesh);
+    const Material* currentMaterial = intersectedMesh->GetMaterial();
+    assert(currentMaterial);
+    return currentMaterial;
 }
 
 void Scene::PerformRaySpecularReflection(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state) const
@@ -104,3 +216,52 @@ void Scene::Finalize()
     assert(acceleration);
     acceleration->Initialize(sceneObjects);
 }
+
+uint64_t Scene::ComputeGeometryHash() const
+{
+    uint64_t hash = Hash::HashCombine(Hash::FNV_OFFSET_BASIS, static_cast<uint64_t>(sceneObjects.size()));
+    for (size_t i = 0; i < sceneObjects.size(); ++i) {
+        const SceneObject& object = *sceneObjects[i].get();
+        hash = HashVector(object.GetObjectToWorldMatrix(), hash);
+        hash = Hash::HashCombine(hash, static_cast<uint64_t>(object.GetTotalMeshObjects()));
+        for (int m = 0; m < object.GetTotalMeshObjects(); ++m) {
+            const MeshObject* meshObject = object.GetMeshObject(m);
+            hash = meshObject->ComputeGeometryHash(hash);
+
+            const Material* material = meshObject->GetMaterial();
+            if (!material) {
+                hash = Hash::HashCombine(hash, 0);
+                continue;
+            }
+            hash = Hash::HashCombine(hash, material->HasDiffuseReflection() ? 2 : 1);
+            hash = HashVector(material->GetBaseDiffuseReflection(), hash);
+            hash = HashVector(material->GetBaseSpecularReflection(), hash);
+            hash = HashVector(material->GetBaseTransmittance(), hash);
+            const float indexOfRefraction = material->GetIOR();
+            hash = Hash::HashValue(indexOfRefraction, hash);
+        }
+    }
+    return hash;
+}
+
+uint64_t Scene::ComputeLightHash() const
+{
+    uint64_t hash = Hash::HashCombine(Hash::FNV_OFFSET_BASIS, static_cast<uint64_t>(sceneLights.size()));
+    for (size_t i = 0; i < sceneLights.size(); ++i) {
+        const Light& light = *sceneLights[i].get();
+        const char* typeName = typeid(light).name();
+        hash = Hash::HashBytes(typeName, std::strlen(typeName), hash);
+        hash = HashVector(light.GetObjectToWorldMatrix(), hash);
+        hash = HashVector(light.GetLightColor(), hash);
+
+        LightBounds bounds;
+        if (light.ComputeLightBounds(bounds)) {
+            hash = HashVector(bounds.bounds.minVertex, hash);
+            hash = HashVector(bounds.bounds.maxVertex, hash);
+            hash = HashVector(bounds.axis, hash);
+            hash = Hash::HashValue(bounds.normalAngle, hash);
+            hash = Hash::HashValue(bounds.emissionAngle, hash);
+        }
+    }
+    return hash;
+}
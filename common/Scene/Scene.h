@@ -10,14 +10,32 @@ class SceneObject;
 class Scene : public std::enable_shared_from_this<Scene>
 {
 public:
+    Scene();
+
     void GenerateDefaultAccelerationData();
     class AccelerationStructure* GenerateAccelerationData(AccelerationTypes inputType);
 
     // if outputIntersection is NULL, this merely checks whether or not the inputRay hits something.
     // if outputIntersection is NOT NULL, then this will check whether or not the inputRay hits something,
-    //      and if it does, it will store that information and perform reflection/refraction and keep going.
+    //      and if it does, it will store that information. Reflection/refraction rays are only traced once shading
+    //      asks for them through TraceReflection/TraceRefraction.
     bool Trace(class Ray* inputRay, IntersectionState* outputIntersection) const;
 
+    // Fraction of light that makes it along inputRay (up to its max T) through transmissive surfaces: every crossing
+    // multiplies in the square root of the surface's base transmittance. Zero as soon as anything opaque is in the
+    // way. All hits are gathered in one traversal in no particular order; inputRay is consumed.
+    glm::vec3 ComputeShadowTransmittance(class Ray* inputRay) const;
+
+    // Traces the reflection (refraction) ray of a hit the first time it is requested and remembers the result in the
+    // intersection. Returns nullptr if the material does not reflect (refract) or the bounce limit has been reached.
+    const IntersectionState* TraceReflection(const IntersectionState& intersection) const;
+    const IntersectionState* TraceRefraction(const IntersectionState& intersection) const;
+
+    // Secondary rays whose path throughput (the largest channel) drops below minimumContribution are not traced. With
+    // Russian roulette they are instead traced with probability throughput / minimumContribution and weighted up to
+    // keep the estimate unbiased. A threshold of 0 traces every ray up to the bounce limits.
+    void SetSecondaryRayCulling(float minimumContribution, bool useRussianRoulette);
+
     size_t GetTotalObjects() const
     {
         return sceneObjects.size();
@@ -50,11 +68,23 @@ public:
 
     void Finalize();
 
+    // Hashes for keying caches of lighting computed over the scene (see PhotonMapCache); call after Finalize. The
+    // geometry hash covers every object's transform and mesh shapes plus the material parameters light transport reads
+    // (textures are not included); the light hash covers each light's type, transform, color and emission bounds.
+    uint64_t ComputeGeometryHash() const;
+    uint64_t ComputeLightHash() const;
+
     void PerformRaySpecularReflection(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state) const;
     void PerformRayRefraction(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state, float& targetIOR) const;
 private:
+    const class Material* GetIntersectedMaterial(const IntersectionState& intersection) const;
+    bool ShouldTraceSecondaryRay(const glm::vec3& throughput, float& russianRouletteWeight) const;
+
     std::shared_ptr<class AccelerationStructure> acceleration;
 
     std::vector<std::shared_ptr<SceneObject>> sceneObjects;
     std::vector<std::shared_ptr<Light>> sceneLights;
+
+    float minimumRayContribution;
+    bool russianRoulette;
 };
\ No newline at end of file
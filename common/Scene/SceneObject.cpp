@@ -6,7 +6,7 @@
 const float SceneObject::MINIMUM_SCALE = 0.01f;
 
 SceneObject::SceneObject():
-    worldToObjectMatrix(1.f), objectToWorldMatrix(1.f), position(0.f, 0.f, 0.f, 1.f), rotation(1.f, 0.f, 0.f, 0.f), scale(1.f), nameSet(false)
+    worldToObjectMatrix(1.f), objectToWorldMatrix(1.f), objectToWorldNormalMatrix(1.f), position(0.f, 0.f, 0.f, 1.f), rotation(1.f, 0.f, 0.f, 0.f), scale(1.f), nameSet(false)
 {
 }
 
@@ -25,6 +25,11 @@ glm::mat4 SceneObject::GetWorldToObjectMatrix() const
     return worldToObjectMatrix;
 }
 
+glm::mat3 SceneObject::GetObjectToWorldNormalMatrix() const
+{
+    return objectToWorldNormalMatrix;
+}
+
 void SceneObject::UpdateTransformationMatrix()
 {
     objectToWorldMatrix = glm::mat4(1.f);
@@ -32,6 +37,7 @@ void SceneObject::UpdateTransformationMatrix()
     objectToWorldMatrix = glm::mat4_cast(rotation) * objectToWorldMatrix;
     objectToWorldMatrix = glm::translate(glm::mat4(1.f), glm::vec3(position)) * objectToWorldMatrix;
     worldToObjectMatrix = glm::inverse(objectToWorldMatrix);
+    objectToWorldNormalMatrix = glm::mat3(glm::transpose(worldToObjectMatrix));
 }
 
 glm::vec4 SceneObject::GetForwardDirection() const
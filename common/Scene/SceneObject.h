@@ -12,6 +12,9 @@ public:
     virtual glm::mat4 GetObjectToWorldMatrix() const;
     virtual glm::mat4 GetWorldToObjectMatrix() const;
 
+    // Transforms object space normals to world space (the inverse transpose of the object to world matrix).
+    virtual glm::mat3 GetObjectToWorldNormalMatrix() const;
+
     virtual glm::vec4 GetForwardDirection() const;
     virtual glm::vec4 GetRightDirection() const;
     virtual glm::vec4 GetUpDirection() const;
@@ -65,6 +68,7 @@ protected:
     virtual void UpdateTransformationMatrix();
     glm::mat4 worldToObjectMatrix;
     glm::mat4 objectToWorldMatrix;
+    glm::mat3 objectToWorldNormalMatrix;
 
     glm::vec4 position;
     glm::quat rotation;
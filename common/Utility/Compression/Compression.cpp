@@ -0,0 +1,125 @@
+#include "common/Utility/Compression/Compression.h"
+
+namespace Compression
+{
+
+namespace
+{
+
+// Inverses of UnpackSnorm2x16 and UnpackSnorm2x8, rounding to the nearest step like glm::packSnorm2x16 and
+// glm::packSnorm2x8.
+uint32_t PackSnorm2x16(const glm::vec2& value)
+{
+    const glm::vec2 scaled = glm::clamp(value, -1.f, 1.f) * 32767.f;
+    const uint16_t x = static_cast<uint16_t>(static_cast<int16_t>(std::round(scaled.x)));
+    const uint16_t y = static_cast<uint16_t>(static_cast<int16_t>(std::round(scaled.y)));
+    return static_cast<uint32_t>(x) | (static_cast<uint32_t>(y) << 16);
+}
+
+uint16_t PackSnorm2x8(const glm::vec2& value)
+{
+    const glm::vec2 scaled = glm::clamp(value, -1.f, 1.f) * 127.f;
+    const uint8_t x = static_cast<uint8_t>(static_cast<int8_t>(std::round(scaled.x)));
+    const uint8_t y = static_cast<uint8_t>(static_cast<int8_t>(std::round(scaled.y)));
+    return static_cast<uint16_t>(x | (y << 8));
+}
+
+// Nearest half-precision float, ties away from zero; too large values become infinity and too small ones zero.
+uint16_t PackHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(float));
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const int exponent = static_cast<int>((bits >> 23) & 0xFF) - (127 - 15);
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0xFF - (127 - 15)) {
+        // Infinity, or a NaN that keeps its leading mantissa bits (and at least one of them so it stays a NaN).
+        return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? std::max(mantissa >> 13, 1u) : 0u));
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        // Denormal half. Rounding up may carry into the exponent, which gives the smallest normal half as it should.
+        mantissa = (mantissa | 0x800000) >> (1 - exponent);
+        return static_cast<uint16_t>(sign | ((mantissa + 0x1000) >> 13));
+    }
+
+    // A carry out of the mantissa moves on to the next exponent; past the largest one the result is infinity.
+    const uint32_t rounded = ((static_cast<uint32_t>(exponent) << 23) | mantissa) + 0x1000;
+    if (rounded >= (31u << 23)) {
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+    return static_cast<uint16_t>(sign | (rounded >> 13));
+}
+
+}
+
+uint32_t EncodeOctahedral(const glm::vec3& unitVector)
+{
+    const float l1Norm = std::abs(unitVector.x) + std::abs(unitVector.y) + std::abs(unitVector.z);
+    if (l1Norm < SMALL_EPSILON) {
+        // Degenerate input (e.g. a missing tangent). Store +Z rather than NaNs.
+        return PackSnorm2x16(glm::vec2(0.f));
+    }
+
+    glm::vec2 p = glm::vec2(unitVector) / l1Norm;
+    if (unitVector.z < 0.f) {
+        p = glm::vec2((1.f - std::abs(p.y)) * (p.x >= 0.f ? 1.f : -1.f), (1.f - std::abs(p.x)) * (p.y >= 0.f ? 1.f : -1.f));
+    }
+    return PackSnorm2x16(p);
+}
+
+uint16_t EncodeOctahedral16(const glm::vec3& unitVector)
+{
+    const float l1Norm = std::abs(unitVector.x) + std::abs(unitVector.y) + std::abs(unitVector.z);
+    if (l1Norm < SMALL_EPSILON) {
+        return PackSnorm2x8(glm::vec2(0.f));
+    }
+
+    glm::vec2 p = glm::vec2(unitVector) / l1Norm;
+    if (unitVector.z < 0.f) {
+        p = glm::vec2((1.f - std::abs(p.y)) * (p.x >= 0.f ? 1.f : -1.f), (1.f - std::abs(p.x)) * (p.y >= 0.f ? 1.f : -1.f));
+    }
+    return PackSnorm2x8(p);
+}
+
+uint32_t EncodeHalf2(const glm::vec2& value)
+{
+    return static_cast<uint32_t>(PackHalf(value.x)) | (static_cast<uint32_t>(PackHalf(value.y)) << 16);
+}
+
+uint32_t EncodeRGBE(const glm::vec3& color)
+{
+    const glm::vec3 clamped = glm::max(color, glm::vec3(0.f));
+    const float maximum = std::max(clamped.x, std::max(clamped.y, clamped.z));
+    if (maximum < 1e-32f) {
+        return 0;
+    }
+
+    // maximum = fraction * 2^exponent with the fraction in [0.5, 1), so the largest mantissa uses the full byte.
+    int exponent;
+    const float fraction = std::frexp(maximum, &exponent);
+    const float scale = fraction * 256.f / maximum;
+    const uint32_t r = std::min(static_cast<uint32_t>(clamped.x * scale), 255u);
+    const uint32_t g = std::min(static_cast<uint32_t>(clamped.y * scale), 255u);
+    const uint32_t b = std::min(static_cast<uint32_t>(clamped.z * scale), 255u);
+    return r | (g << 8) | (b << 16) | (static_cast<uint32_t>(exponent + 128) << 24);
+}
+
+glm::vec3 ComputeQuantizationScale(const glm::vec3& minimum, const glm::vec3& maximum)
+{
+    // Flat axes still get a non-zero scale so that decoding never divides by zero.
+    return glm::max(maximum - minimum, glm::vec3(SMALL_EPSILON)) / 65535.f;
+}
+
+void QuantizePosition(const glm::vec3& position, const glm::vec3& minimum, const glm::vec3& scale, uint16_t output[3])
+{
+    const glm::vec3 quantized = glm::clamp(glm::round((position - minimum) / scale), glm::vec3(0.f), glm::vec3(65535.f));
+    for (int i = 0; i < 3; ++i) {
+        output[i] = static_cast<uint16_t>(quantized[i]);
+    }
+}
+
+}
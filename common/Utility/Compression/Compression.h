@@ -0,0 +1,108 @@
+#pragma once
+
+#ifndef __COMPRESSION__
+#define __COMPRESSION__
+
+#include "common/common.h"
+#include <cstring>
+
+// Lossy encodings for geometric data that is stored in bulk. The decoders are on the hot path of intersection and
+// shading so they are kept inline. glm's packing functions are not used: they type-pun through unions and pointer
+// casts, which trips strict-aliasing warnings.
+namespace Compression
+{
+
+// Signed normalized components as glm::unpackSnorm2x16 and glm::unpackSnorm2x8 decode them, x in the low bits.
+inline glm::vec2 UnpackSnorm2x16(uint32_t packed)
+{
+    const glm::vec2 p(static_cast<int16_t>(packed & 0xFFFF), static_cast<int16_t>(packed >> 16));
+    return glm::clamp(p * (1.f / 32767.f), -1.f, 1.f);
+}
+
+inline glm::vec2 UnpackSnorm2x8(uint16_t packed)
+{
+    const glm::vec2 p(static_cast<int8_t>(packed & 0xFF), static_cast<int8_t>(packed >> 8));
+    return glm::clamp(p * (1.f / 127.f), -1.f, 1.f);
+}
+
+// Octahedral encoding of a unit vector into two 16-bit signed normalized components. The maximum angular error is well
+// under a hundredth of a degree.
+uint32_t EncodeOctahedral(const glm::vec3& unitVector);
+
+inline glm::vec3 DecodeOctahedral(uint32_t encoded)
+{
+    const glm::vec2 p = UnpackSnorm2x16(encoded);
+    glm::vec3 v(p.x, p.y, 1.f - std::abs(p.x) - std::abs(p.y));
+    if (v.z < 0.f) {
+        v.x = (1.f - std::abs(p.y)) * (p.x >= 0.f ? 1.f : -1.f);
+        v.y = (1.f - std::abs(p.x)) * (p.y >= 0.f ? 1.f : -1.f);
+    }
+    return glm::normalize(v);
+}
+
+// Octahedral encoding into two 8-bit components, for directions that tolerate an error of about a degree.
+uint16_t EncodeOctahedral16(const glm::vec3& unitVector);
+
+inline glm::vec3 DecodeOctahedral16(uint16_t encoded)
+{
+    const glm::vec2 p = UnpackSnorm2x8(encoded);
+    glm::vec3 v(p.x, p.y, 1.f - std::abs(p.x) - std::abs(p.y));
+    if (v.z < 0.f) {
+        v.x = (1.f - std::abs(p.y)) * (p.x >= 0.f ? 1.f : -1.f);
+        v.y = (1.f - std::abs(p.x)) * (p.y >= 0.f ? 1.f : -1.f);
+    }
+    return glm::normalize(v);
+}
+
+// Shared-exponent RGB (Ward's RGBE): three 8-bit mantissas and one exponent byte. Keeps about 1% relative precision
+// over any range of magnitudes; negative components are stored as zero.
+uint32_t EncodeRGBE(const glm::vec3& color);
+
+inline glm::vec3 DecodeRGBE(uint32_t encoded)
+{
+    const int exponent = static_cast<int>(encoded >> 24);
+    if (!exponent) {
+        return glm::vec3(0.f);
+    }
+    const float scale = std::ldexp(1.f, exponent - (128 + 8));
+    return glm::vec3((encoded & 0xFF) + 0.5f, ((encoded >> 8) & 0xFF) + 0.5f, ((encoded >> 16) & 0xFF) + 0.5f) * scale;
+}
+
+// IEEE half-precision float to single precision; exact for every half, including denormals, infinities and NaNs.
+inline float UnpackHalf(uint16_t half)
+{
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1F;
+    const uint32_t mantissa = half & 0x3FF;
+    if (!exponent) {
+        // Zero or denormal: mantissa * 2^-24.
+        const float magnitude = static_cast<float>(mantissa) * (1.f / 16777216.f);
+        return sign ? -magnitude : magnitude;
+    }
+    const uint32_t bits = sign | ((exponent == 0x1F) ? 0x7F800000 : ((exponent + (127 - 15)) << 23)) | (mantissa << 13);
+    float value;
+    std::memcpy(&value, &bits, sizeof(float));
+    return value;
+}
+
+// Two IEEE half-precision floats, x in the low bits.
+uint32_t EncodeHalf2(const glm::vec2& value);
+
+inline glm::vec2 DecodeHalf2(uint32_t encoded)
+{
+    return glm::vec2(UnpackHalf(static_cast<uint16_t>(encoded & 0xFFFF)), UnpackHalf(static_cast<uint16_t>(encoded >> 16)));
+}
+
+// Positions are quantized to 16 bits per axis relative to a bounding box. Decoding is minimum + quantized * scale where
+// scale comes from ComputeQuantizationScale.
+glm::vec3 ComputeQuantizationScale(const glm::vec3& minimum, const glm::vec3& maximum);
+void QuantizePosition(const glm::vec3& position, const glm::vec3& minimum, const glm::vec3& scale, uint16_t output[3]);
+
+inline glm::vec3 DequantizePosition(const uint16_t input[3], const glm::vec3& minimum, const glm::vec3& scale)
+{
+    return minimum + scale * glm::vec3(input[0], input[1], input[2]);
+}
+
+}
+
+#endif
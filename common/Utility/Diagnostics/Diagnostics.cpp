@@ -1,5 +1,6 @@
 #include "common/common.h"
 #include "common/Utility/Diagnostics/Diagnostics.h"
+#include <algorithm>
 
 #if DIAGNOSTICS_ON
 
@@ -11,24 +12,70 @@ Diagnostics* Diagnostics::Get()
 
 Diagnostics::Diagnostics()
 {
+    finishedThreadTotals.fill(0);
+}
+
+Diagnostics::ThreadStatistics::ThreadStatistics()
+{
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+    Diagnostics* diagnostics = Diagnostics::Get();
+    std::lock_guard<std::mutex> lock(diagnostics->diagnosticsMutex);
+    diagnostics->liveThreads.push_back(this);
+}
+
+Diagnostics::ThreadStatistics::~ThreadStatistics()
+{
+    Diagnostics* diagnostics = Diagnostics::Get();
+    std::lock_guard<std::mutex> lock(diagnostics->diagnosticsMutex);
+    for (size_t i = 0; i < counts.size(); ++i) {
+        diagnostics->finishedThreadTotals[i] += counts[i].load(std::memory_order_relaxed);
+    }
+    diagnostics->liveThreads.erase(std::find(diagnostics->liveThreads.begin(), diagnostics->liveThreads.end(), this));
+}
+
+Diagnostics::ThreadStatistics& Diagnostics::GetThreadStatistics()
+{
+    static thread_local ThreadStatistics statistics;
+    return statistics;
 }
 
 void Diagnostics::IncrementStat(DiagnosticsType type)
 {
-    ++statisticsAggregator[type];
+    // Only this thread writes its counters; the atomics just let Print read them while it runs.
+    std::atomic<uint64_t>& count = GetThreadStatistics().counts[static_cast<size_t>(type)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+uint64_t Diagnostics::GetTotal(DiagnosticsType type)
+{
+    const size_t index = static_cast<size_t>(type);
+    std::lock_guard<std::mutex> lock(diagnosticsMutex);
+    uint64_t total = finishedThreadTotals[index];
+    for (size_t i = 0; i < liveThreads.size(); ++i) {
+        total += liveThreads[i]->counts[index].load(std::memory_order_relaxed);
+    }
+    return total;
 }
 
 void Diagnostics::Log(const std::string& log)
 {
+    std::lock_guard<std::mutex> lock(diagnosticsMutex);
     std::cout << log << std::endl;
 }
 
 void Diagnostics::Print()
 {
     std::cout << "====================== DIAGNOSTICS START ======================" << std::endl;
-    std::cout << "Ray-Triangle Intersections: " << statisticsAggregator[DiagnosticsType::TRIANGLE_INTERSECTIONS] << std::endl;
-    std::cout << "Ray-Box Intersections: " << statisticsAggregator[DiagnosticsType::BOX_INTERSECTIONS] << std::endl;
-    std::cout << "Rays Created: " << statisticsAggregator[DiagnosticsType::RAYS_CREATED] << std::endl;
+    std::cout << "Ray-Triangle Intersections: " << GetTotal(DiagnosticsType::TRIANGLE_INTERSECTIONS) << std::endl;
+    std::cout << "Ray-Sphere Intersections: " << GetTotal(DiagnosticsType::SPHERE_INTERSECTIONS) << std::endl;
+    std::cout << "Ray-Quad Intersections: " << GetTotal(DiagnosticsType::QUAD_INTERSECTIONS) << std::endl;
+    std::cout << "Ray-Box Intersections: " << GetTotal(DiagnosticsType::BOX_INTERSECTIONS) << std::endl;
+    std::cout << "Rays Created: " << GetTotal(DiagnosticsType::RAYS_CREATED) << std::endl;
+    std::cout << "Secondary Rays Skipped: " << GetTotal(DiagnosticsType::SECONDARY_RAYS_SKIPPED) << std::endl;
+    std::cout << "Geometry Chunk Page-Ins: " << GetTotal(DiagnosticsType::GEOMETRY_CHUNK_PAGE_INS) << std::endl;
+    std::cout << "Geometry Chunk Evictions: " << GetTotal(DiagnosticsType::GEOMETRY_CHUNK_EVICTIONS) << std::endl;
     std::cout << "====================== DIAGNOSTICS END ========================" << std::endl;
 }
 
@@ -5,8 +5,13 @@
 enum class DiagnosticsType
 {
     TRIANGLE_INTERSECTIONS = 0,
+    SPHERE_INTERSECTIONS,
+    QUAD_INTERSECTIONS,
     BOX_INTERSECTIONS,
     RAYS_CREATED,
+    SECONDARY_RAYS_SKIPPED,
+    GEOMETRY_CHUNK_PAGE_INS,
+    GEOMETRY_CHUNK_EVICTIONS,
     MAX
 };
 
@@ -18,8 +23,12 @@ enum class DiagnosticsType
 #define DIAGNOSTICS_LOG(S) Diagnostics::Get()->Log(S)
 
 #include <memory>
-#include <map>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
 
+// Safe to use from any thread.
 class Diagnostics
 {
 public:
@@ -31,8 +40,24 @@ public:
     void Print();
     void Log(const std::string& log);
 private:
+    static const size_t TOTAL_STATISTICS = static_cast<size_t>(DiagnosticsType::MAX);
 
-    std::map<DiagnosticsType, int> statisticsAggregator;
+    // Every thread counts into its own set of counters so that hot statistics (e.g. intersections) never contend. The
+    // counts of a thread are folded into finishedThreadTotals when it exits.
+    struct ThreadStatistics
+    {
+        ThreadStatistics();
+        ~ThreadStatistics();
+
+        std::array<std::atomic<uint64_t>, TOTAL_STATISTICS> counts;
+    };
+
+    static ThreadStatistics& GetThreadStatistics();
+    uint64_t GetTotal(DiagnosticsType type);
+
+    std::mutex diagnosticsMutex;
+    std::vector<ThreadStatistics*> liveThreads;
+    std::array<uint64_t, TOTAL_STATISTICS> finishedThreadTotals;
 };
 
 #else
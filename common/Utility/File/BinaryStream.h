@@ -0,0 +1,86 @@
+#pragma once
+
+#include "common/common.h"
+#include <cstring>
+#include <fstream>
+
+// Helpers for the flat binary formats (mesh cache, geometry chunks). Every block is padded to 4 bytes so that the float
+// and index arrays can be used in place once the file is memory-mapped.
+inline size_t PaddedBinarySize(size_t bytes)
+{
+    return (bytes + 3) & ~static_cast<size_t>(3);
+}
+
+class BinaryReader
+{
+public:
+    BinaryReader(const unsigned char* inputData, size_t inputSize) :
+        data(inputData), size(inputSize), offset(0)
+    {
+    }
+
+    // Returns a pointer to the next block and advances past it (and its padding), or nullptr if the file is truncated.
+    const unsigned char* Consume(size_t bytes)
+    {
+        const size_t padded = PaddedBinarySize(bytes);
+        if (padded > size - offset) {
+            return nullptr;
+        }
+        const unsigned char* block = data + offset;
+        offset += padded;
+        return block;
+    }
+
+    const unsigned char* Current() const
+    {
+        return data + offset;
+    }
+
+    template<typename T>
+    bool Read(T& output)
+    {
+        const unsigned char* block = Consume(sizeof(T));
+        if (!block) {
+            return false;
+        }
+        std::memcpy(&output, block, sizeof(T));
+        return true;
+    }
+
+    template<typename T>
+    bool ReadArray(const T*& output, size_t count)
+    {
+        output = reinterpret_cast<const T*>(Consume(sizeof(T) * count));
+        return output != nullptr;
+    }
+private:
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+};
+
+class BinaryWriter
+{
+public:
+    BinaryWriter(std::ofstream& inputStream) :
+        stream(inputStream)
+    {
+    }
+
+    void Write(const void* block, size_t bytes)
+    {
+        static const char padding[4] = { 0, 0, 0, 0 };
+        if (bytes) {
+            stream.write(static_cast<const char*>(block), bytes);
+        }
+        stream.write(padding, PaddedBinarySize(bytes) - bytes);
+    }
+
+    template<typename T>
+    void Write(const T& value)
+    {
+        Write(&value, sizeof(T));
+    }
+private:
+    std::ofstream& stream;
+};
@@ -0,0 +1,145 @@
+#include "common/Utility/File/MappedFile.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() :
+    data(nullptr), size(0)
+#ifdef _WIN32
+    , fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& filename)
+{
+    Close();
+#ifdef _WIN32
+    fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        Close();
+        return false;
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        Close();
+        return false;
+    }
+
+    data = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        Close();
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int fileDescriptor = open(filename.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        return false;
+    }
+
+    struct stat fileInfo;
+    if (fstat(fileDescriptor, &fileInfo) != 0 || fileInfo.st_size == 0) {
+        close(fileDescriptor);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    // The mapping keeps its own reference to the file.
+    close(fileDescriptor);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    data = static_cast<const unsigned char*>(mapping);
+    size = static_cast<size_t>(fileInfo.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+    }
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (data) {
+        munmap(const_cast<unsigned char*>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+bool MappedFile::GetModificationTime(const std::string& filename, int64_t& outputTime)
+{
+    struct stat fileInfo;
+    if (stat(filename.c_str(), &fileInfo) != 0) {
+        return false;
+    }
+    outputTime = static_cast<int64_t>(fileInfo.st_mtime);
+    return true;
+}
+
+bool MappedFile::GetFileSize(const std::string& filename, uint64_t& outputSize)
+{
+    struct stat fileInfo;
+    if (stat(filename.c_str(), &fileInfo) != 0) {
+        return false;
+    }
+    outputSize = static_cast<uint64_t>(fileInfo.st_size);
+    return true;
+}
+
+std::string MappedFile::GetTemporaryFilename(const std::string& filename)
+{
+    static std::atomic<uint64_t> totalTemporaryFiles(0);
+#ifdef _WIN32
+    const uint64_t processId = static_cast<uint64_t>(GetCurrentProcessId());
+#else
+    const uint64_t processId = static_cast<uint64_t>(getpid());
+#endif
+    std::ostringstream temporaryFilename;
+    temporaryFilename << filename << "." << processId << "." << totalTemporaryFiles++ << ".tmp";
+    return temporaryFilename.str();
+}
+
+bool MappedFile::ReplaceFile(const std::string& sourceFilename, const std::string& targetFilename)
+{
+#ifdef _WIN32
+    return MoveFileExA(sourceFilename.c_str(), targetFilename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(sourceFilename.c_str(), targetFilename.c_str()) == 0;
+#endif
+}
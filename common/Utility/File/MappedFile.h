@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common/common.h"
+
+// Read-only memory mapping of an entire file. The mapping stays valid until Close() is called or the object is destroyed,
+// so anything pointing into GetData() must not outlive the MappedFile.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool Open(const std::string& filename);
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    const unsigned char* GetData() const { return data; }
+    size_t GetSize() const { return size; }
+
+    // Returns false if the file does not exist.
+    static bool GetModificationTime(const std::string& filename, int64_t& outputTime);
+    static bool GetFileSize(const std::string& filename, uint64_t& outputSize);
+
+    // Name next to 'filename' that no other writer in this or any other process uses, for writing a file under a
+    // temporary name and renaming it into place once it is complete.
+    static std::string GetTemporaryFilename(const std::string& filename);
+
+    // Renames 'sourceFilename' to 'targetFilename', atomically replacing the target if it exists: a concurrent reader
+    // sees either the old or the new file, and the old one survives a failed replace.
+    static bool ReplaceFile(const std::string& sourceFilename, const std::string& targetFilename);
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data;
+    size_t size;
+
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
@@ -0,0 +1,32 @@
+#include "common/Utility/Hash/Hash.h"
+
+namespace Hash
+{
+
+uint64_t HashBytes(const void* data, size_t totalBytes, uint64_t seed)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < totalBytes; ++i) {
+        hash ^= static_cast<uint64_t>(bytes[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t HashCombine(uint64_t seed, uint64_t value)
+{
+    return HashValue(value, seed);
+}
+
+uint64_t MixBits(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+}
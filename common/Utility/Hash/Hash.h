@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common/common.h"
+#include <type_traits>
+
+namespace Hash
+{
+// 64-bit FNV-1a. Not cryptographic, but fast and stable across platforms and runs which is all we need for cache keys.
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+
+uint64_t HashBytes(const void* data, size_t totalBytes, uint64_t seed = FNV_OFFSET_BASIS);
+uint64_t HashCombine(uint64_t seed, uint64_t value);
+
+// Avalanches the bits of a single integer (the MurmurHash3 finalizer). Much cheaper than HashValue when one integer
+// has to be turned into a well-mixed seed inside a hot loop.
+uint64_t MixBits(uint64_t value);
+
+template<typename T>
+uint64_t HashValue(const T& value, uint64_t seed = FNV_OFFSET_BASIS)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "HashValue only supports trivially copyable types.");
+    return HashBytes(&value, sizeof(T), seed);
+}
+}
@@ -0,0 +1,66 @@
+#include "common/Utility/Mesh/Cache/MaterialSerialization.h"
+#include "common/Utility/File/BinaryStream.h"
+#include "assimp/material.h"
+
+namespace MaterialSerialization
+{
+
+namespace
+{
+
+struct MaterialPropertyRecord
+{
+    uint32_t keyLength;
+    uint32_t semantic;
+    uint32_t index;
+    uint32_t type;
+    uint32_t dataLength;
+};
+
+}
+
+void WriteMaterial(BinaryWriter& writer, const aiMaterial& material)
+{
+    writer.Write(static_cast<uint32_t>(material.mNumProperties));
+    for (unsigned int p = 0; p < material.mNumProperties; ++p) {
+        const aiMaterialProperty* source = material.mProperties[p];
+        MaterialPropertyRecord property;
+        property.keyLength = static_cast<uint32_t>(source->mKey.length);
+        property.semantic = source->mSemantic;
+        property.index = source->mIndex;
+        property.type = static_cast<uint32_t>(source->mType);
+        property.dataLength = source->mDataLength;
+        writer.Write(property);
+        writer.Write(source->mKey.C_Str(), property.keyLength);
+        writer.Write(source->mData, property.dataLength);
+    }
+}
+
+bool SkipMaterial(BinaryReader& reader)
+{
+    uint32_t totalProperties = 0;
+    bool isValid = reader.Read(totalProperties);
+    for (uint32_t p = 0; p < totalProperties && isValid; ++p) {
+        MaterialPropertyRecord property;
+        isValid = reader.Read(property) && reader.Consume(property.keyLength) && reader.Consume(property.dataLength);
+    }
+    return isValid;
+}
+
+std::shared_ptr<aiMaterial> ReadMaterial(BinaryReader& reader)
+{
+    std::shared_ptr<aiMaterial> material = std::make_shared<aiMaterial>();
+    uint32_t totalProperties = 0;
+    reader.Read(totalProperties);
+    for (uint32_t p = 0; p < totalProperties; ++p) {
+        MaterialPropertyRecord property;
+        reader.Read(property);
+        const char* key = reinterpret_cast<const char*>(reader.Consume(property.keyLength));
+        const unsigned char* propertyData = reader.Consume(property.dataLength);
+        material->AddBinaryProperty(propertyData, property.dataLength, std::string(key, property.keyLength).c_str(),
+            property.semantic, property.index, static_cast<aiPropertyTypeInfo>(property.type));
+    }
+    return material;
+}
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "common/common.h"
+
+struct aiMaterial;
+class BinaryReader;
+class BinaryWriter;
+
+// Binary records of Assimp material property lists, shared by the files that store materials next to their geometry
+// (MeshCache, GeometryChunkFile). A record is the property count followed by every property's key, semantic, index,
+// type and raw data.
+namespace MaterialSerialization
+{
+
+void WriteMaterial(BinaryWriter& writer, const aiMaterial& material);
+
+// Moves past a record, checking that all of it is there. Returns false if it is truncated.
+bool SkipMaterial(BinaryReader& reader);
+
+// Recreates the material from a record that SkipMaterial accepted.
+std::shared_ptr<aiMaterial> ReadMaterial(BinaryReader& reader);
+
+}
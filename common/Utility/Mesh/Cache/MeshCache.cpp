@@ -0,0 +1,198 @@
+#include "common/Utility/Mesh/Cache/MeshCache.h"
+#include "common/Utility/Mesh/Cache/MaterialSerialization.h"
+#include "common/Utility/File/BinaryStream.h"
+#include <cstdio>
+
+namespace
+{
+
+const uint32_t MESH_CACHE_MAGIC = 0x434D5452; // "RTMC"
+
+const uint32_t HAS_NORMALS = 1 << 0;
+const uint32_t HAS_UVS = 1 << 1;
+const uint32_t HAS_TANGENTS_AND_BITANGENTS = 1 << 2;
+
+struct MeshCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t importFlags;
+    uint32_t totalMeshes;
+    uint32_t totalMaterials;
+    uint32_t reserved;
+    int64_t sourceTimestamp;
+    uint64_t sourceHash;
+};
+
+struct MeshCacheMeshRecord
+{
+    uint32_t nameLength;
+    uint32_t materialIndex;
+    uint32_t totalVertices;
+    uint32_t totalIndices;
+    uint32_t totalQuadIndices;
+    uint32_t attributes;
+};
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float) && sizeof(glm::vec2) == 2 * sizeof(float), "Mesh cache arrays are mapped directly onto glm vectors.");
+
+}
+
+const uint32_t MeshCache::CURRENT_VERSION = 2;
+
+std::string MeshCache::GetCachePath(const std::string& sourceFilename, uint32_t importFlags)
+{
+    std::ostringstream cachePath;
+    cachePath << sourceFilename << "." << std::hex << importFlags << ".rtcache";
+    return cachePath.str();
+}
+
+bool MeshCache::Open(const std::string& cacheFilename, int64_t sourceTimestamp, uint64_t sourceHash, uint32_t importFlags)
+{
+    Close();
+    if (!mappedFile.Open(cacheFilename)) {
+        return false;
+    }
+
+    BinaryReader reader(mappedFile.GetData(), mappedFile.GetSize());
+    MeshCacheHeader header;
+    if (!reader.Read(header) || header.magic != MESH_CACHE_MAGIC || header.version != CURRENT_VERSION ||
+        header.importFlags != importFlags || header.sourceTimestamp != sourceTimestamp || header.sourceHash != sourceHash) {
+        Close();
+        return false;
+    }
+
+    bool isValid = true;
+    for (uint32_t m = 0; m < header.totalMaterials && isValid; ++m) {
+        materialRecords.push_back(reader.Current());
+        isValid = MaterialSerialization::SkipMaterial(reader);
+    }
+
+    for (uint32_t i = 0; i < header.totalMeshes && isValid; ++i) {
+        MeshCacheMeshRecord record;
+        const char* name = nullptr;
+        if (!reader.Read(record) || !reader.ReadArray(name, record.nameLength)) {
+            isValid = false;
+            break;
+        }
+
+        MeshAttributeView view;
+        view.name.assign(name, record.nameLength);
+        view.materialIndex = record.materialIndex;
+        view.totalVertices = record.totalVertices;
+        view.totalIndices = record.totalIndices;
+        view.totalQuadIndices = record.totalQuadIndices;
+        isValid = reader.ReadArray(view.positions, record.totalVertices);
+        if (isValid && (record.attributes & HAS_NORMALS)) {
+            isValid = reader.ReadArray(view.normals, record.totalVertices);
+        }
+        if (isValid && (record.attributes & HAS_UVS)) {
+            isValid = reader.ReadArray(view.uvs, record.totalVertices);
+        }
+        if (isValid && (record.attributes & HAS_TANGENTS_AND_BITANGENTS)) {
+            isValid = reader.ReadArray(view.tangents, record.totalVertices) && reader.ReadArray(view.bitangents, record.totalVertices);
+        }
+        isValid = isValid && reader.ReadArray(view.indices, record.totalIndices) && record.materialIndex < header.totalMaterials;
+        for (uint32_t index = 0; index < record.totalIndices && isValid; ++index) {
+            isValid = view.indices[index] < record.totalVertices;
+        }
+        if (isValid && record.totalQuadIndices) {
+            isValid = reader.ReadArray(view.quadIndices, record.totalQuadIndices) && record.totalQuadIndices % 4 == 0;
+            for (uint32_t index = 0; index < record.totalQuadIndices && isValid; ++index) {
+                isValid = view.quadIndices[index] < record.totalVertices;
+            }
+        }
+        meshes.push_back(view);
+    }
+
+    if (!isValid) {
+        std::cerr << "WARNING: Mesh cache " << cacheFilename << " is malformed. Ignoring it." << std::endl;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MeshCache::Close()
+{
+    meshes.clear();
+    materialRecords.clear();
+    mappedFile.Close();
+}
+
+std::shared_ptr<aiMaterial> MeshCache::CreateMaterial(size_t index) const
+{
+    assert(index < materialRecords.size());
+    // The record was already validated in Open() so we do not need to bounds check it again.
+    BinaryReader reader(materialRecords[index], mappedFile.GetSize() - (materialRecords[index] - mappedFile.GetData()));
+    return MaterialSerialization::ReadMaterial(reader);
+}
+
+bool MeshCache::Write(const std::string& cacheFilename, int64_t sourceTimestamp, uint64_t sourceHash, uint32_t importFlags,
+    const std::vector<MeshAttributeView>& meshes, const std::vector<const aiMaterial*>& materials)
+{
+    // Write to a temporary file first so a crash or a concurrent reader never sees a half-written cache.
+    const std::string temporaryFilename = MappedFile::GetTemporaryFilename(cacheFilename);
+    {
+        std::ofstream stream(temporaryFilename, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            return false;
+        }
+        BinaryWriter writer(stream);
+
+        MeshCacheHeader header;
+        header.magic = MESH_CACHE_MAGIC;
+        header.version = CURRENT_VERSION;
+        header.importFlags = importFlags;
+        header.totalMeshes = static_cast<uint32_t>(meshes.size());
+        header.totalMaterials = static_cast<uint32_t>(materials.size());
+        header.reserved = 0;
+        header.sourceTimestamp = sourceTimestamp;
+        header.sourceHash = sourceHash;
+        writer.Write(header);
+
+        for (size_t m = 0; m < materials.size(); ++m) {
+            MaterialSerialization::WriteMaterial(writer, *materials[m]);
+        }
+
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            const MeshAttributeView& view = meshes[i];
+            MeshCacheMeshRecord record;
+            record.nameLength = static_cast<uint32_t>(view.name.size());
+            record.materialIndex = view.materialIndex;
+            record.totalVertices = view.totalVertices;
+            record.totalIndices = view.totalIndices;
+            record.totalQuadIndices = view.quadIndices ? view.totalQuadIndices : 0;
+            record.attributes = (view.normals ? HAS_NORMALS : 0) | (view.uvs ? HAS_UVS : 0) | ((view.tangents && view.bitangents) ? HAS_TANGENTS_AND_BITANGENTS : 0);
+            writer.Write(record);
+            writer.Write(view.name.data(), view.name.size());
+            writer.Write(view.positions, sizeof(glm::vec3) * view.totalVertices);
+            if (record.attributes & HAS_NORMALS) {
+                writer.Write(view.normals, sizeof(glm::vec3) * view.totalVertices);
+            }
+            if (record.attributes & HAS_UVS) {
+                writer.Write(view.uvs, sizeof(glm::vec2) * view.totalVertices);
+            }
+            if (record.attributes & HAS_TANGENTS_AND_BITANGENTS) {
+                writer.Write(view.tangents, sizeof(glm::vec3) * view.totalVertices);
+                writer.Write(view.bitangents, sizeof(glm::vec3) * view.totalVertices);
+            }
+            writer.Write(view.indices, sizeof(unsigned int) * view.totalIndices);
+            if (record.totalQuadIndices) {
+                writer.Write(view.quadIndices, sizeof(unsigned int) * record.totalQuadIndices);
+            }
+        }
+
+        if (!stream) {
+            stream.close();
+            std::remove(temporaryFilename.c_str());
+            return false;
+        }
+    }
+
+    if (!MappedFile::ReplaceFile(temporaryFilename, cacheFilename)) {
+        std::remove(temporaryFilename.c_str());
+        return false;
+    }
+    return true;
+}
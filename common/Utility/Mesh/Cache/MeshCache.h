@@ -0,0 +1,35 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Utility/File/MappedFile.h"
+#include "common/Utility/Mesh/Loading/MeshAttributeView.h"
+
+struct aiMaterial;
+
+// Versioned binary cache of the geometry MeshLoader extracts from Assimp (positions, normals, UVs, tangents, indices and
+// material indices) plus the material property lists. The cache is memory-mapped when opened and the mesh views point
+// directly into the mapping, so it must stay open for as long as the views are in use.
+class MeshCache
+{
+public:
+    static const uint32_t CURRENT_VERSION;
+
+    // Every set of import flags gets its own file, so loading the same asset with different flags does not keep
+    // replacing one cache with the other.
+    static std::string GetCachePath(const std::string& sourceFilename, uint32_t importFlags);
+
+    // Returns false if the cache is missing, malformed, from another version or does not match the source key.
+    bool Open(const std::string& cacheFilename, int64_t sourceTimestamp, uint64_t sourceHash, uint32_t importFlags);
+    void Close();
+
+    const std::vector<MeshAttributeView>& GetMeshes() const { return meshes; }
+    size_t GetTotalMaterials() const { return materialRecords.size(); }
+    std::shared_ptr<aiMaterial> CreateMaterial(size_t index) const;
+
+    static bool Write(const std::string& cacheFilename, int64_t sourceTimestamp, uint64_t sourceHash, uint32_t importFlags,
+        const std::vector<MeshAttributeView>& meshes, const std::vector<const aiMaterial*>& materials);
+private:
+    MappedFile mappedFile;
+    std::vector<MeshAttributeView> meshes;
+    std::vector<const unsigned char*> materialRecords;
+};
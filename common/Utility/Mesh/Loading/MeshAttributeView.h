@@ -0,0 +1,33 @@
+#pragma once
+
+#include "common/common.h"
+
+// Non-owning view over the indexed vertex data of a single mesh. The data may live in buffers filled from Assimp or
+// directly inside a memory-mapped mesh cache; either way the primitives are built straight from these pointers.
+struct MeshAttributeView
+{
+    MeshAttributeView() :
+        materialIndex(0), totalVertices(0), totalIndices(0), totalQuadIndices(0), positions(nullptr), normals(nullptr), uvs(nullptr), tangents(nullptr), bitangents(nullptr), indices(nullptr), quadIndices(nullptr)
+    {
+    }
+
+    std::string name;
+    unsigned int materialIndex;
+    unsigned int totalVertices;
+    unsigned int totalIndices;
+    unsigned int totalQuadIndices;
+
+    // Optional attributes are nullptr when the mesh does not have them.
+    const glm::vec3* positions;
+    const glm::vec3* normals;
+    const glm::vec2* uvs;
+    const glm::vec3* tangents;
+    const glm::vec3* bitangents;
+
+    // Three indices per triangle.
+    const unsigned int* indices;
+
+    // Four indices per planar quad, in order around the face. Only meshes loaded with MeshLoadOptions::preserveQuads
+    // have quads; everything else is triangulated into indices.
+    const unsigned int* quadIndices;
+};
@@ -1,7 +1,17 @@
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Utility/Mesh/Loading/MeshLoader.h"
+#include "common/Utility/Mesh/Cache/MeshCache.h"
 #include "common/Scene/Geometry/Primitives/Triangle/Triangle.h"
+#include "common/Scene/Geometry/Primitives/CompressedTriangle/CompressedTriangle.h"
+#include "common/Scene/Geometry/Primitives/CompressedTriangle/CompressedVertexBuffer.h"
+#include "common/Scene/Geometry/Primitives/Sphere/Sphere.h"
+#include "common/Scene/Geometry/Primitives/Quad/Quad.h"
 #include "common/Scene/Geometry/Primitives/PrimitiveBase.h"
+#include "common/Utility/File/MappedFile.h"
+#include "common/Utility/Hash/Hash.h"
+#include "common/Utility/Threading/ParallelFor.h"
+#include "common/Utility/Mesh/Streaming/GeometryChunkFile.h"
+#include "common/Scene/Geometry/Mesh/Streaming/StreamingMeshObject.h"
 #include "assimp/Importer.hpp"
 #include "assimp/scene.h"
 #include "assimp/postprocess.h"
@@ -10,62 +20,446 @@
 #include "common/Scene/Geometry/Primitives/Primitive.h"
 #include <map>
 #include <queue>
+#include <new>
+#include <type_traits>
+
+#define USE_MESH_CACHE 1
 
 namespace MeshLoader
 {
 
-void LoadFaceIntoPrimitive(const aiFace& face, PrimitiveBase& primitive, std::vector<glm::vec3>& allPosition, std::vector<glm::vec3>& allNormals, std::vector<glm::vec2>& allUV, std::vector<glm::vec3>& allTangents, std::vector<glm::vec3>& allBitangents)
+namespace
 {
-    LoadFaceIntoPrimitive(face.mNumIndices, face.mIndices, primitive, allPosition, allNormals, allUV, allTangents, allBitangents);
+
+const unsigned int IMPORT_FLAGS = aiProcess_GenNormals |
+    aiProcess_CalcTangentSpace |
+    aiProcess_Triangulate |
+    aiProcess_JoinIdenticalVertices |
+    aiProcess_FixInfacingNormals |
+    aiProcess_FindInstances |
+    aiProcess_SortByPType;
+
+// Faces are kept as polygons so that planar quads survive; ExtractMeshBuffers triangulates everything else itself.
+// Sorting by primitive type is left out as well so every mesh keeps its triangles and quads together and the mesh count
+// matches the default import.
+const unsigned int QUAD_IMPORT_FLAGS = IMPORT_FLAGS & ~(aiProcess_Triangulate | aiProcess_SortByPType);
+
+// Owning storage for one mesh that was extracted from Assimp. The cache path skips this entirely and uses the mapped data.
+struct MeshBuffers
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> tangents;
+    std::vector<glm::vec3> bitangents;
+    std::vector<unsigned int> indices;
+    std::vector<unsigned int> quadIndices;
+
+    MeshAttributeView CreateView(const std::string& name, unsigned int materialIndex) const
+    {
+        MeshAttributeView view;
+        view.name = name;
+        view.materialIndex = materialIndex;
+        view.totalVertices = static_cast<unsigned int>(positions.size());
+        view.totalIndices = static_cast<unsigned int>(indices.size());
+        view.positions = positions.data();
+        view.normals = normals.empty() ? nullptr : normals.data();
+        view.uvs = uvs.empty() ? nullptr : uvs.data();
+        view.tangents = tangents.empty() ? nullptr : tangents.data();
+        view.bitangents = bitangents.empty() ? nullptr : bitangents.data();
+        view.indices = indices.data();
+        view.totalQuadIndices = static_cast<unsigned int>(quadIndices.size());
+        view.quadIndices = quadIndices.empty() ? nullptr : quadIndices.data();
+        return view;
+    }
+};
+
+// Ear clipping for faces Assimp did not triangulate. The polygon is projected onto the plane its (Newell) normal is most
+// aligned with so concave polygons come out right as well.
+void TriangulatePolygon(const aiFace& face, const std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+{
+    glm::vec3 normal(0.f);
+    for (unsigned int i = 0; i < face.mNumIndices; ++i) {
+        const glm::vec3& current = positions[face.mIndices[i]];
+        const glm::vec3& next = positions[face.mIndices[(i + 1) % face.mNumIndices]];
+        normal += glm::vec3((current.y - next.y) * (current.z + next.z), (current.z - next.z) * (current.x + next.x), (current.x - next.x) * (current.y + next.y));
+    }
+    const glm::vec3 absNormal = glm::abs(normal);
+    const int dropAxis = (absNormal.x >= absNormal.y && absNormal.x >= absNormal.z) ? 0 : ((absNormal.y >= absNormal.z) ? 1 : 2);
+    const int uAxis = (dropAxis + 1) % 3;
+    const int vAxis = (dropAxis + 2) % 3;
+    const float orientation = (normal[dropAxis] >= 0.f) ? 1.f : -1.f;
+
+    std::vector<glm::vec2> projected(face.mNumIndices);
+    for (unsigned int i = 0; i < face.mNumIndices; ++i) {
+        const glm::vec3& position = positions[face.mIndices[i]];
+        projected[i] = glm::vec2(position[uAxis], position[vAxis]);
+    }
+
+    auto cross = [](const glm::vec2& a, const glm::vec2& b, const glm::vec2& c) {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    };
+
+    std::vector<unsigned int> remaining(face.mNumIndices);
+    for (unsigned int i = 0; i < face.mNumIndices; ++i) {
+        remaining[i] = i;
+    }
+
+    // Starting at the second corner makes convex polygons come out as a fan around the first one, which is what Assimp
+    // does as well.
+    size_t current = 1;
+    size_t attempts = 0;
+    while (remaining.size() > 3) {
+        const size_t total = remaining.size();
+        const unsigned int previous = remaining[(current + total - 1) % total];
+        const unsigned int ear = remaining[current];
+        const unsigned int next = remaining[(current + 1) % total];
+
+        bool isEar = orientation * cross(projected[previous], projected[ear], projected[next]) > 0.f;
+        for (size_t i = 0; i < total && isEar; ++i) {
+            const unsigned int other = remaining[i];
+            if (other == previous || other == ear || other == next) {
+                continue;
+            }
+            isEar = !(orientation * cross(projected[previous], projected[ear], projected[other]) >= 0.f &&
+                orientation * cross(projected[ear], projected[next], projected[other]) >= 0.f &&
+                orientation * cross(projected[next], projected[previous], projected[other]) >= 0.f);
+        }
+
+        // Degenerate or self-intersecting polygons may have no ear left; clip the current corner anyway after a full pass.
+        if (!isEar && ++attempts <= total) {
+            current = (current + 1) % total;
+            continue;
+        }
+
+        indices.push_back(face.mIndices[previous]);
+        indices.push_back(face.mIndices[ear]);
+        indices.push_back(face.mIndices[next]);
+        remaining.erase(remaining.begin() + current);
+        current %= remaining.size();
+        attempts = 0;
+    }
+
+    for (size_t i = 0; i < remaining.size(); ++i) {
+        indices.push_back(face.mIndices[remaining[i]]);
+    }
 }
 
-    void LoadFaceIntoPrimitive(unsigned int numVertices, unsigned int* indices, PrimitiveBase& primitive, std::vector<glm::vec3>& allPosition, std::vector<glm::vec3>& allNormals, std::vector<glm::vec2>& allUV, std::vector<glm::vec3>& allTangents, std::vector<glm::vec3>& allBitangents)
+void ExtractMeshBuffers(const aiMesh* mesh, MeshBuffers& buffers)
 {
-    assert(numVertices == primitive.GetTotalVertices());
-    bool hasNormals = allNormals.size() == allPosition.size();
-    bool hasUV = allUV.size() == allPosition.size();
-    bool hasTangentsAndBitangents = (allTangents.size() == allPosition.size()) && (allBitangents.size() == allPosition.size());
+    const auto totalVertices = mesh->mNumVertices;
+    buffers.positions.resize(totalVertices);
+    if (mesh->HasNormals()) {
+        buffers.normals.resize(totalVertices);
+    }
 
-    for (unsigned int i = 0; i < numVertices; ++i) {
-        primitive.SetVertexPosition(i, allPosition[indices[i]]);
+    if (mesh->HasTextureCoords(0)) {
+        buffers.uvs.resize(totalVertices);
+    }
+
+    if (mesh->HasTangentsAndBitangents()) {
+        buffers.tangents.resize(totalVertices);
+        buffers.bitangents.resize(totalVertices);
+    }
+
+    for (decltype(mesh->mNumVertices) v = 0; v < totalVertices; ++v) {
+        buffers.positions[v] = glm::vec3(mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z);
 
-        if (hasNormals) {
-            primitive.SetVertexNormal(i, allNormals[indices[i]]);
+        if (mesh->HasNormals()) {
+            buffers.normals[v] = glm::vec3(mesh->mNormals[v].x, mesh->mNormals[v].y, mesh->mNormals[v].z);
         }
 
-        if (hasUV) {
-            primitive.SetVertexUV(i, allUV[indices[i]]);
+        if (mesh->HasTextureCoords(0)) {
+            buffers.uvs[v] = glm::vec2(mesh->mTextureCoords[0][v].x, mesh->mTextureCoords[0][v].y);
         }
 
-        if (hasTangentsAndBitangents) {
-            primitive.SetVertexTangentBitangent(i, allTangents[indices[i]], allBitangents[indices[i]]);
+        if (mesh->HasTangentsAndBitangents()) {
+            buffers.tangents[v] = glm::vec3(mesh->mTangents[v].x, mesh->mTangents[v].y, mesh->mTangents[v].z);
+            buffers.bitangents[v] = glm::vec3(mesh->mBitangents[v].x, mesh->mBitangents[v].y, mesh->mBitangents[v].z);
+        }
+    }
+
+    if (mesh->HasFaces()) {
+        buffers.indices.reserve(mesh->mNumFaces * 3);
+        for (decltype(mesh->mNumFaces) f = 0; f < mesh->mNumFaces; ++f) {
+            const aiFace& face = mesh->mFaces[f];
+            if (face.mNumIndices < 3) {
+                std::cerr << "WARNING: Input mesh has an unsupported primitive type. Skipping face with: " << face.mNumIndices << " vertices." << std::endl;
+                continue;
+            }
+
+            if (face.mNumIndices == 3) {
+                buffers.indices.insert(buffers.indices.end(), face.mIndices, face.mIndices + 3);
+            } else if (face.mNumIndices == 4 && Quad::IsPlanarConvexQuad(buffers.positions[face.mIndices[0]], buffers.positions[face.mIndices[1]],
+                buffers.positions[face.mIndices[2]], buffers.positions[face.mIndices[3]])) {
+                buffers.quadIndices.insert(buffers.quadIndices.end(), face.mIndices, face.mIndices + 4);
+            } else {
+                TriangulatePolygon(face, buffers.positions, buffers.indices);
+            }
+        }
+    } else {
+        // Assume triangles
+        assert(totalVertices % 3 == 0);
+        buffers.indices.resize(totalVertices);
+        for (decltype(mesh->mNumVertices) v = 0; v < totalVertices; ++v) {
+            buffers.indices[v] = v;
+        }
+    }
+}
+
+// Primitives in a mesh are converted in chunks of this size so that a single large mesh still spreads over every thread.
+const size_t PRIMITIVE_GRAIN_SIZE = 4096;
+
+// Storage for all the primitives of one mesh in a single allocation. The primitives are constructed in place by whichever
+// thread converts them, and the shared pointers handed to the MeshObject alias into the block and keep all of it alive.
+template<typename T>
+class PrimitiveBlock
+{
+public:
+    explicit PrimitiveBlock(size_t inputTotalPrimitives) :
+        storage(new Storage[inputTotalPrimitives]), totalPrimitives(inputTotalPrimitives)
+    {
+    }
+
+    // Every primitive has to be constructed before the block is destroyed.
+    ~PrimitiveBlock()
+    {
+        for (size_t p = 0; p < totalPrimitives; ++p) {
+            (*this)[p].~T();
+        }
+    }
+
+    T* Construct(size_t index, MeshObject* parent)
+    {
+        return new (&storage[index]) T(parent);
+    }
+
+    T& operator[](size_t index)
+    {
+        return *reinterpret_cast<T*>(&storage[index]);
+    }
+private:
+    PrimitiveBlock(const PrimitiveBlock&) = delete;
+    PrimitiveBlock& operator=(const PrimitiveBlock&) = delete;
+
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+    std::unique_ptr<Storage[]> storage;
+    size_t totalPrimitives;
+};
+
+// Creates one primitive of type T for every N indices in the given index array of each mesh and appends them to the
+// matching MeshObject. The unique ids primitives get as acceleration nodes follow whichever thread gets there first;
+// only scene objects use theirs.
+template<typename T, unsigned int N>
+void CreatePrimitives(const std::vector<MeshAttributeView>& meshes, const std::vector<std::shared_ptr<MeshObject>>& loadedMeshes,
+    const unsigned int* MeshAttributeView::* indices, unsigned int MeshAttributeView::* totalIndices)
+{
+    std::vector<std::shared_ptr<PrimitiveBlock<T>>> meshPrimitives(meshes.size());
+    std::vector<std::vector<std::shared_ptr<PrimitiveBase>>> meshElements(meshes.size());
+    std::vector<size_t> firstPrimitive(meshes.size() + 1, 0);
+    for (size_t m = 0; m < meshes.size(); ++m) {
+        const size_t totalPrimitives = meshes[m].*indices ? meshes[m].*totalIndices / N : 0;
+        meshPrimitives[m] = std::make_shared<PrimitiveBlock<T>>(totalPrimitives);
+        meshElements[m].resize(totalPrimitives);
+        firstPrimitive[m + 1] = firstPrimitive[m] + totalPrimitives;
+    }
+
+    // Treat the primitives of every mesh as one range so small meshes share chunks with large ones.
+    Threading::ParallelFor(0, firstPrimitive.back(), PRIMITIVE_GRAIN_SIZE, [&](size_t begin, size_t end) {
+        size_t m = std::upper_bound(firstPrimitive.begin(), firstPrimitive.end(), begin) - firstPrimitive.begin() - 1;
+        for (size_t p = begin; p < end; ++p) {
+            while (p >= firstPrimitive[m + 1]) {
+                ++m;
+            }
+            const size_t localPrimitive = p - firstPrimitive[m];
+            T* primitive = meshPrimitives[m]->Construct(localPrimitive, loadedMeshes[m].get());
+            LoadFaceIntoPrimitive(N, meshes[m].*indices + localPrimitive * N, *primitive, meshes[m]);
+            meshElements[m][localPrimitive] = std::shared_ptr<PrimitiveBase>(meshPrimitives[m], primitive);
+        }
+    });
+
+    for (size_t m = 0; m < meshes.size(); ++m) {
+        loadedMeshes[m]->AddPrimitives(std::move(meshElements[m]));
+    }
+}
+
+std::vector<std::shared_ptr<MeshObject>> CreateMeshObjects(const std::vector<MeshAttributeView>& meshes)
+{
+    std::vector<std::shared_ptr<MeshObject>> loadedMeshes(meshes.size());
+    for (size_t m = 0; m < meshes.size(); ++m) {
+        loadedMeshes[m] = std::make_shared<MeshObject>();
+        loadedMeshes[m]->SetName(meshes[m].name);
+    }
+
+    CreatePrimitives<Triangle, 3>(meshes, loadedMeshes, &MeshAttributeView::indices, &MeshAttributeView::totalIndices);
+    CreatePrimitives<Quad, 4>(meshes, loadedMeshes, &MeshAttributeView::quadIndices, &MeshAttributeView::totalQuadIndices);
+    return loadedMeshes;
+}
+
+// Owns everything the primitives of a compressed mesh refer to. The shared pointers handed to the MeshObject alias into
+// this object.
+struct CompressedMeshStorage
+{
+    CompressedMeshStorage(const MeshAttributeView& mesh) :
+        vertices(mesh)
+    {
+    }
+
+    CompressedVertexBuffer vertices;
+    std::vector<CompressedTriangle> triangles;
+};
+
+std::vector<std::shared_ptr<MeshObject>> CreateCompressedMeshObjects(const std::vector<MeshAttributeView>& meshes)
+{
+    // Compressing the vertices is where the time goes; the triangles are just three indices each.
+    std::vector<std::shared_ptr<CompressedMeshStorage>> meshStorage(meshes.size());
+    Threading::ParallelFor(0, meshes.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t m = begin; m < end; ++m) {
+            meshStorage[m] = std::make_shared<CompressedMeshStorage>(meshes[m]);
+        }
+    });
+
+    std::vector<std::shared_ptr<MeshObject>> loadedMeshes(meshes.size());
+    for (size_t m = 0; m < meshes.size(); ++m) {
+        loadedMeshes[m] = std::make_shared<MeshObject>();
+        loadedMeshes[m]->SetName(meshes[m].name);
+
+        // Quads are split along their first diagonal; there is no compressed quad primitive.
+        std::vector<CompressedTriangle>& triangles = meshStorage[m]->triangles;
+        const size_t totalTriangles = meshes[m].totalIndices / 3;
+        const size_t totalQuads = meshes[m].quadIndices ? meshes[m].totalQuadIndices / 4 : 0;
+        triangles.reserve(totalTriangles + totalQuads * 2);
+        for (size_t t = 0; t < totalTriangles; ++t) {
+            triangles.emplace_back(loadedMeshes[m].get(), &meshStorage[m]->vertices, meshes[m].indices + t * 3);
         }
+        for (size_t q = 0; q < totalQuads; ++q) {
+            const unsigned int* quad = meshes[m].quadIndices + q * 4;
+            const unsigned int secondTriangle[3] = { quad[0], quad[2], quad[3] };
+            triangles.emplace_back(loadedMeshes[m].get(), &meshStorage[m]->vertices, quad);
+            triangles.emplace_back(loadedMeshes[m].get(), &meshStorage[m]->vertices, secondTriangle);
+        }
+        std::vector<std::shared_ptr<PrimitiveBase>> elements(triangles.size());
+        for (size_t t = 0; t < triangles.size(); ++t) {
+            elements[t] = std::shared_ptr<PrimitiveBase>(meshStorage[m], &triangles[t]);
+        }
+        loadedMeshes[m]->AddPrimitives(std::move(elements));
     }
+    return loadedMeshes;
 }
 
-std::vector<std::shared_ptr<MeshObject>> LoadMesh(const std::string& filename, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials)
+// Tessellations with fewer vertices than this are left alone; they are more likely meant to look faceted.
+const unsigned int MINIMUM_SPHERE_VERTICES = 32;
+
+// Checks whether every vertex lies on a common sphere (within tolerance * radius) with normals pointing outwards.
+bool FitSphere(const MeshAttributeView& mesh, float tolerance, glm::vec3& center, float& radius)
 {
+    if (mesh.totalVertices < MINIMUM_SPHERE_VERTICES) {
+        return false;
+    }
+
+    Box bounds;
+    for (unsigned int v = 0; v < mesh.totalVertices; ++v) {
+        bounds.IncludeBox(Box(mesh.positions[v], mesh.positions[v]));
+    }
+    center = bounds.Center();
+
+    double totalDistance = 0.0;
+    for (unsigned int v = 0; v < mesh.totalVertices; ++v) {
+        totalDistance += glm::length(mesh.positions[v] - center);
+    }
+    radius = static_cast<float>(totalDistance / mesh.totalVertices);
+    if (radius < SMALL_EPSILON) {
+        return false;
+    }
+
+    for (unsigned int v = 0; v < mesh.totalVertices; ++v) {
+        const glm::vec3 offset = mesh.positions[v] - center;
+        const float distance = glm::length(offset);
+        if (std::abs(distance - radius) > tolerance * radius) {
+            return false;
+        }
+        if (mesh.normals && glm::dot(mesh.normals[v], offset) <= 0.f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<MeshObject> CreateSphereMeshObject(const std::string& name, const glm::vec3& center, float radius)
+{
+    std::shared_ptr<MeshObject> newMesh = std::make_shared<MeshObject>();
+    newMesh->SetName(name);
+    newMesh->AddPrimitive(std::make_shared<Sphere>(newMesh.get(), center, radius));
+    return newMesh;
+}
 
+std::string GetCompleteFilename(const std::string& filename)
+{
 #ifndef ASSET_PATH
     static_assert(false, "ASSET_PATH is not defined. Check to make sure your projects are setup correctly");
 #endif
+    return std::string(STRINGIFY(ASSET_PATH)) + "/" + filename;
+}
+
+// Identifies the contents of a source file. Both the timestamp and a hash are used so that touching the file without
+// changing it or restoring an older copy with the same timestamp are both handled correctly.
+struct SourceKey
+{
+    SourceKey() :
+        isValid(false), timestamp(0), hash(0)
+    {
+    }
+
+    bool isValid;
+    int64_t timestamp;
+    uint64_t hash;
+};
+
+SourceKey ComputeSourceKey(const std::string& completeFilename)
+{
+    SourceKey key;
+    MappedFile sourceFile;
+    if (MappedFile::GetModificationTime(completeFilename, key.timestamp) && sourceFile.Open(completeFilename)) {
+        key.hash = Hash::HashBytes(sourceFile.GetData(), sourceFile.GetSize());
+        key.isValid = true;
+    }
+    return key;
+}
+
+// Imports every mesh in the file (from the mesh cache when possible) and hands them to the visitor. The views are only
+// valid during the call. Materials are output in the same order as the meshes.
+bool VisitMeshes(const std::string& filename, const SourceKey& sourceKey, unsigned int importFlags, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials,
+    const std::function<void(const std::vector<MeshAttributeView>&)>& visitor)
+{
+    const std::string completeFilename = GetCompleteFilename(filename);
+
+#if USE_MESH_CACHE
+    const std::string cacheFilename = MeshCache::GetCachePath(completeFilename, importFlags);
+    MeshCache cache;
+    if (sourceKey.isValid && cache.Open(cacheFilename, sourceKey.timestamp, sourceKey.hash, importFlags)) {
+        const std::vector<MeshAttributeView>& cachedMeshes = cache.GetMeshes();
+        if (outputMaterials) {
+            std::vector<std::shared_ptr<aiMaterial>> sceneMaterials(cache.GetTotalMaterials());
+            for (size_t i = 0; i < cachedMeshes.size(); ++i) {
+                const unsigned int materialIndex = cachedMeshes[i].materialIndex;
+                if (!sceneMaterials[materialIndex]) {
+                    sceneMaterials[materialIndex] = cache.CreateMaterial(materialIndex);
+                }
+                outputMaterials->push_back(sceneMaterials[materialIndex]);
+            }
+        }
+        visitor(cachedMeshes);
+        return true;
+    }
+#endif
 
     Assimp::Importer importer;
     importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_LINE | aiPrimitiveType_POINT);
 
-    const std::string completeFilename = std::string(STRINGIFY(ASSET_PATH)) + "/" + filename;
-
-    const aiScene* scene = importer.ReadFile(completeFilename.c_str(),
-            aiProcess_GenNormals |
-            aiProcess_CalcTangentSpace       | 
-            aiProcess_Triangulate            |
-            aiProcess_JoinIdenticalVertices  |
-            aiProcess_FixInfacingNormals |
-            aiProcess_FindInstances |
-            aiProcess_SortByPType);
+    const aiScene* scene = importer.ReadFile(completeFilename.c_str(), importFlags);
     if (!scene) {
         std::cerr << "ERROR: Assimp failed -- " << importer.GetErrorString() << std::endl;
-        return {};
+        return false;
     }
 
     std::vector<std::shared_ptr<aiMaterial>> sceneMaterials;
@@ -79,100 +473,187 @@ std::vector<std::shared_ptr<MeshObject>> LoadMesh(const std::string& filename, s
         }
     }
 
-    std::vector<std::shared_ptr<MeshObject>> loadedMeshes;
+    // Traverse nodes to find the mesh names
+    std::vector<std::string> meshNames(scene->mNumMeshes);
+    std::queue<aiNode*> nodes;
+    nodes.push(scene->mRootNode);
+    while (!nodes.empty()) {
+        aiNode* currentNode = nodes.front();
+        nodes.pop();
+
+        if (currentNode->mNumMeshes) {
+            for (unsigned int i = 0; i < currentNode->mNumMeshes; ++i) {
+                meshNames[currentNode->mMeshes[i]] = currentNode->mName.C_Str();
+            }
+        }
+
+        for (unsigned int i = 0; i < currentNode->mNumChildren; ++i) {
+            nodes.push(currentNode->mChildren[i]);
+        }
+    }
+
+    std::vector<unsigned int> validMeshes;
     for (decltype(scene->mNumMeshes) i = 0; i < scene->mNumMeshes; ++i) {
-        const aiMesh* mesh = scene->mMeshes[i];
-        if (!mesh->HasPositions()) {
+        if (!scene->mMeshes[i]->HasPositions()) {
             std::cerr << "WARNING: A mesh in " << filename << " does not have positions. Skipping." << std::endl;
             continue;
         }
-        std::shared_ptr<MeshObject> newMesh = std::make_shared<MeshObject>();
-        auto totalVertices = mesh->mNumVertices;
-        std::vector<glm::vec3> allPosition(totalVertices);
-        std::vector<glm::vec3> allNormals;
-        if (mesh->HasNormals()) {
-            allNormals.resize(totalVertices);
+        validMeshes.push_back(i);
+    }
+
+    // Each aiMesh is converted independently; the scene is only read from here on.
+    std::vector<MeshBuffers> meshBuffers(validMeshes.size());
+    Threading::ParallelFor(0, validMeshes.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            ExtractMeshBuffers(scene->mMeshes[validMeshes[i]], meshBuffers[i]);
         }
+    });
 
-        std::vector<glm::vec2> allUV;
-        if (mesh->HasTextureCoords(0)) {
-            allUV.resize(totalVertices);
+    std::vector<MeshAttributeView> meshViews;
+    for (size_t i = 0; i < validMeshes.size(); ++i) {
+        meshViews.push_back(meshBuffers[i].CreateView(meshNames[validMeshes[i]], scene->mMeshes[validMeshes[i]]->mMaterialIndex));
+    }
+
+#if USE_MESH_CACHE
+    if (sourceKey.isValid) {
+        std::vector<const aiMaterial*> cacheMaterials(scene->mMaterials, scene->mMaterials + scene->mNumMaterials);
+        if (!MeshCache::Write(cacheFilename, sourceKey.timestamp, sourceKey.hash, importFlags, meshViews, cacheMaterials)) {
+            std::cerr << "WARNING: Failed to write the mesh cache for " << filename << std::endl;
         }
+    }
+#endif
 
-        std::vector<glm::vec3> allTangents;
-        std::vector<glm::vec3> allBitangents;
-        if (mesh->HasTangentsAndBitangents()) {
-            allTangents.resize(totalVertices);
-            allBitangents.resize(totalVertices);
+    if (outputMaterials) {
+        for (size_t i = 0; i < meshViews.size(); ++i) {
+            outputMaterials->push_back(sceneMaterials[meshViews[i].materialIndex]);
+        }
+    }
+    visitor(meshViews);
+    return true;
+}
+
+}
+
+void LoadFaceIntoPrimitive(unsigned int numVertices, const unsigned int* indices, PrimitiveBase& primitive, const MeshAttributeView& mesh)
+{
+    assert(numVertices == static_cast<unsigned int>(primitive.GetTotalVertices()));
+    const bool hasTangentsAndBitangents = mesh.tangents && mesh.bitangents;
+
+    for (unsigned int i = 0; i < numVertices; ++i) {
+        primitive.SetVertexPosition(i, mesh.positions[indices[i]]);
+
+        if (mesh.normals) {
+            primitive.SetVertexNormal(i, mesh.normals[indices[i]]);
         }
 
-        for (decltype(totalVertices) v = 0; v < totalVertices; ++v) {
-            allPosition[v] = glm::vec3(mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z);
-            
-            if (mesh->HasNormals()) {
-                allNormals[v] = glm::vec3(mesh->mNormals[v].x, mesh->mNormals[v].y, mesh->mNormals[v].z);
-            }
+        if (mesh.uvs) {
+            primitive.SetVertexUV(i, mesh.uvs[indices[i]]);
+        }
 
-            if (mesh->HasTextureCoords(0)) {
-                allUV[v] = glm::vec2(mesh->mTextureCoords[0][v].x, mesh->mTextureCoords[0][v].y);
-            }
+        if (hasTangentsAndBitangents) {
+            primitive.SetVertexTangentBitangent(i, mesh.tangents[indices[i]], mesh.bitangents[indices[i]]);
+        }
+    }
+}
+
+std::vector<std::shared_ptr<MeshObject>> LoadMesh(const std::string& filename, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials, const MeshLoadOptions& options)
+{
+    SourceKey sourceKey;
+#if USE_MESH_CACHE
+    sourceKey = ComputeSourceKey(GetCompleteFilename(filename));
+#endif
 
-            if (mesh->HasTangentsAndBitangents()) {
-                allTangents[v] = glm::vec3(mesh->mTangents[v].x, mesh->mTangents[v].y, mesh->mTangents[v].z);
-                allBitangents[v] = glm::vec3(mesh->mBitangents[v].x, mesh->mBitangents[v].y, mesh->mBitangents[v].z);
+    std::vector<std::shared_ptr<MeshObject>> loadedMeshes;
+    VisitMeshes(filename, sourceKey, options.preserveQuads ? QUAD_IMPORT_FLAGS : IMPORT_FLAGS, outputMaterials, [&](const std::vector<MeshAttributeView>& meshes) {
+        loadedMeshes.resize(meshes.size());
+        std::vector<MeshAttributeView> polygonMeshes;
+        std::vector<size_t> polygonMeshSlots;
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            glm::vec3 center;
+            float radius = 0.f;
+            if (options.replaceSpheres && FitSphere(meshes[i], options.sphereTolerance, center, radius)) {
+                loadedMeshes[i] = CreateSphereMeshObject(meshes[i].name, center, radius);
+                continue;
             }
+            polygonMeshes.push_back(meshes[i]);
+            polygonMeshSlots.push_back(i);
         }
 
-        if (mesh->HasFaces()) {
-            for (decltype(mesh->mNumFaces) f = 0; f < mesh->mNumFaces; ++f) {
-                const aiFace& face =  mesh->mFaces[f];
-                std::shared_ptr<PrimitiveBase> newPrimitive = nullptr;
-                if (face.mNumIndices == 3) {
-                    newPrimitive = std::make_shared<Triangle>(newMesh.get());
-                    LoadFaceIntoPrimitive(face, *newPrimitive.get(), allPosition, allNormals, allUV, allTangents, allBitangents);
-                } else {
-                    std::cerr << "WARNING: Input mesh has an unsupported primitive type. Skipping face with: " << face.mNumIndices << " vertices." << std::endl;
-                    continue;
-                }
-                assert(newPrimitive);
-                newMesh->AddPrimitive(newPrimitive);
-            }
-        } else {
-            // Assume triangles
-            assert(totalVertices % 3 == 0);
-            for (decltype(totalVertices) v = 0; v < totalVertices; v += 3) {
-                std::shared_ptr<PrimitiveBase> newPrimitive = std::make_shared<Triangle>(newMesh.get());
-                unsigned int indices[3] = { v, v + 1, v + 2 };
-                LoadFaceIntoPrimitive(3, indices, *newPrimitive.get(), allPosition, allNormals, allUV, allTangents, allBitangents);
-                assert(newPrimitive);
-                newMesh->AddPrimitive(newPrimitive);
-            }
+        std::vector<std::shared_ptr<MeshObject>> polygonMeshObjects = options.compressVertexAttributes ? CreateCompressedMeshObjects(polygonMeshes) : CreateMeshObjects(polygonMeshes);
+        for (size_t i = 0; i < polygonMeshObjects.size(); ++i) {
+            loadedMeshes[polygonMeshSlots[i]] = polygonMeshObjects[i];
+        }
+    });
+    return loadedMeshes;
+}
+
+std::vector<std::shared_ptr<MeshObject>> LoadMeshes(const std::vector<std::string>& filenames, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials, const MeshLoadOptions& options)
+{
+    std::vector<std::vector<std::shared_ptr<MeshObject>>> fileMeshes(filenames.size());
+    std::vector<std::vector<std::shared_ptr<aiMaterial>>> fileMaterials(filenames.size());
+    Threading::ParallelFor(0, filenames.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            fileMeshes[i] = LoadMesh(filenames[i], outputMaterials ? &fileMaterials[i] : nullptr, options);
         }
+    });
 
-        loadedMeshes.push_back(std::move(newMesh));
+    // Concatenate in the order the files were given so the output does not depend on which load finished first.
+    std::vector<std::shared_ptr<MeshObject>> loadedMeshes;
+    for (size_t i = 0; i < filenames.size(); ++i) {
+        loadedMeshes.insert(loadedMeshes.end(), fileMeshes[i].begin(), fileMeshes[i].end());
         if (outputMaterials) {
-            outputMaterials->push_back(sceneMaterials[mesh->mMaterialIndex]);
+            outputMaterials->insert(outputMaterials->end(), fileMaterials[i].begin(), fileMaterials[i].end());
         }
     }
+    return loadedMeshes;
+}
 
-    // Traverse nodes to set mesh names
-    std::queue<aiNode*> nodes;
-    nodes.push(scene->mRootNode);
-    while (!nodes.empty()) {
-        aiNode* currentNode = nodes.front();
-        nodes.pop();
+std::vector<std::shared_ptr<MeshObject>> LoadStreamingMesh(const std::string& filename, std::shared_ptr<GeometryChunkCache> chunkCache, unsigned int maxTrianglesPerChunk,
+    std::vector<std::shared_ptr<aiMaterial>>* outputMaterials)
+{
+    assert(chunkCache && maxTrianglesPerChunk > 0);
+    const std::string completeFilename = GetCompleteFilename(filename);
+    const std::string chunkFilename = GeometryChunkFile::GetChunkFilePath(completeFilename);
 
-        if (currentNode->mNumMeshes) {
-            for (unsigned int i = 0; i < currentNode->mNumMeshes; ++i) {
-                loadedMeshes[currentNode->mMeshes[i]]->SetName(currentNode->mName.C_Str());
+    // The chunk file carries the materials too and is matched without reading the source, so as long as it is current
+    // nothing else is loaded. Only a missing or stale file hashes the source and goes through the regular import (or the
+    // mesh cache) to cut the chunks again.
+    int64_t sourceTimestamp = 0;
+    uint64_t sourceSize = 0;
+    const bool hasSource = MappedFile::GetModificationTime(completeFilename, sourceTimestamp) && MappedFile::GetFileSize(completeFilename, sourceSize);
+    std::shared_ptr<GeometryChunkFile> chunkFile = std::make_shared<GeometryChunkFile>();
+    bool hasChunks = hasSource && chunkFile->Open(chunkFilename, sourceTimestamp, sourceSize, maxTrianglesPerChunk);
+    if (!hasChunks && hasSource) {
+        const SourceKey sourceKey = ComputeSourceKey(completeFilename);
+        std::vector<std::shared_ptr<aiMaterial>> meshMaterials;
+        VisitMeshes(filename, sourceKey, IMPORT_FLAGS, &meshMaterials, [&](const std::vector<MeshAttributeView>& meshes) {
+            std::vector<const aiMaterial*> materials(meshMaterials.size());
+            for (size_t i = 0; i < meshMaterials.size(); ++i) {
+                materials[i] = meshMaterials[i].get();
             }
-        }
+            hasChunks = sourceKey.isValid && GeometryChunkFile::Write(chunkFilename, sourceKey.timestamp, sourceSize, sourceKey.hash, maxTrianglesPerChunk, meshes, materials) &&
+                chunkFile->Open(chunkFilename, sourceKey.timestamp, sourceSize, maxTrianglesPerChunk);
+        });
+    }
 
-        for (unsigned int i = 0; i < currentNode->mNumChildren; ++i) {
-            nodes.push(currentNode->mChildren[i]);
-        }
+    if (!hasChunks) {
+        std::cerr << "ERROR: Failed to create the geometry chunks for " << filename << std::endl;
+        return {};
     }
 
+    std::vector<std::shared_ptr<MeshObject>> loadedMeshes;
+    for (size_t i = 0; i < chunkFile->GetMeshes().size(); ++i) {
+        loadedMeshes.push_back(std::make_shared<StreamingMeshObject>(chunkFile, i, chunkCache));
+    }
+    if (outputMaterials) {
+        std::vector<std::shared_ptr<aiMaterial>> fileMaterials(chunkFile->GetTotalMaterials());
+        for (const GeometryChunkFile::MeshRecord& mesh : chunkFile->GetMeshes()) {
+            if (!fileMaterials[mesh.materialIndex]) {
+                fileMaterials[mesh.materialIndex] = chunkFile->CreateMaterial(mesh.materialIndex);
+            }
+            outputMaterials->push_back(fileMaterials[mesh.materialIndex]);
+        }
+    }
     return loadedMeshes;
 }
 
@@ -4,19 +4,55 @@
 #define __MESH_LOADER__
 
 #include "common/common.h"
+#include "common/Utility/Mesh/Loading/MeshAttributeView.h"
 
 class MeshObject;
 struct aiMaterial;
-struct aiFace;
 class PrimitiveBase;
+class GeometryChunkCache;
 
 namespace MeshLoader
 {
 
-std::vector<std::shared_ptr<MeshObject>> LoadMesh(const std::string& filename, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials = nullptr);
+struct MeshLoadOptions
+{
+    MeshLoadOptions() :
+        compressVertexAttributes(false), replaceSpheres(false), sphereTolerance(0.01f), preserveQuads(false)
+    {
+    }
+
+    // Store the vertex attributes once per mesh in quantized form and create CompressedTriangles that index into them.
+    // Saves most of the geometry memory on big meshes at the cost of decoding attributes whenever they are used.
+    bool compressVertexAttributes;
+
+    // Replace meshes whose vertices all lie on a sphere (within sphereTolerance * radius) by a single analytic Sphere.
+    bool replaceSpheres;
+    float sphereTolerance;
+
+    // Keep planar, convex quad faces as single Quad primitives instead of splitting them into two triangles. Other
+    // polygons are still triangulated.
+    bool preserveQuads;
+};
+
+// Loads every mesh in the file. The extracted geometry is cached in a binary file next to the asset (see MeshCache) and
+// later loads map that cache instead of going through Assimp as long as the source file is unchanged.
+// Meshes in the file are converted in parallel (see Threading::ParallelFor).
+std::vector<std::shared_ptr<MeshObject>> LoadMesh(const std::string& filename, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials = nullptr,
+    const MeshLoadOptions& options = MeshLoadOptions());
+
+// Loads several files concurrently, one file per thread; the conversion inside each file then runs on that thread alone.
+// The result is the same as calling LoadMesh on each file in order and concatenating the outputs.
+std::vector<std::shared_ptr<MeshObject>> LoadMeshes(const std::vector<std::string>& filenames, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials = nullptr,
+    const MeshLoadOptions& options = MeshLoadOptions());
+
+// Streaming variant of LoadMesh for scenes that do not fit in memory. Every mesh is split into spatially coherent chunks
+// of at most maxTrianglesPerChunk triangles which are written next to the asset (see GeometryChunkFile). Only the chunk
+// bounds stay in memory; the geometry is paged in through chunkCache when a ray first reaches a chunk and is evicted
+// again once the cache goes over its memory budget.
+std::vector<std::shared_ptr<MeshObject>> LoadStreamingMesh(const std::string& filename, std::shared_ptr<GeometryChunkCache> chunkCache,
+    unsigned int maxTrianglesPerChunk = 4096, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials = nullptr);
 
-void LoadFaceIntoPrimitive(const aiFace& face, PrimitiveBase& primitive, std::vector<glm::vec3>& allPosition, std::vector<glm::vec3>& allNormals, std::vector<glm::vec2>& allUV, std::vector<glm::vec3>& allTangents, std::vector<glm::vec3>& allBitangents);
-void LoadFaceIntoPrimitive(unsigned int numVertices, unsigned int* indices, PrimitiveBase& primitive, std::vector<glm::vec3>& allPosition, std::vector<glm::vec3>& allNormals, std::vector<glm::vec2>& allUV, std::vector<glm::vec3>& allTangents, std::vector<glm::vec3>& allBitangents);
+void LoadFaceIntoPrimitive(unsigned int numVertices, const unsigned int* indices, PrimitiveBase& primitive, const MeshAttributeView& mesh);
 }
 
 #endif
@@ -0,0 +1,370 @@
+#include "common/Utility/Mesh/Streaming/GeometryChunkFile.h"
+#include "common/Utility/Mesh/Cache/MaterialSerialization.h"
+#include "common/Utility/File/BinaryStream.h"
+#include <cstdio>
+
+namespace
+{
+
+const uint32_t GEOMETRY_CHUNK_MAGIC = 0x43475452; // "RTGC"
+
+const uint32_t HAS_NORMALS = 1 << 0;
+const uint32_t HAS_UVS = 1 << 1;
+const uint32_t HAS_TANGENTS_AND_BITANGENTS = 1 << 2;
+
+struct GeometryChunkHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t maxTrianglesPerChunk;
+    uint32_t totalMeshes;
+    uint32_t totalMaterials;
+    uint32_t reserved;
+    int64_t sourceTimestamp;
+    uint64_t sourceSize;
+    uint64_t sourceHash;
+    uint64_t tableOffset;
+};
+
+struct GeometryChunkMeshHeader
+{
+    uint32_t nameLength;
+    uint32_t materialIndex;
+    uint32_t attributes;
+    uint32_t totalChunks;
+};
+
+struct GeometryChunkTableEntry
+{
+    float minVertex[3];
+    float maxVertex[3];
+    uint32_t totalVertices;
+    uint32_t totalIndices;
+    uint64_t offset;
+};
+
+uint32_t GetAttributes(const MeshAttributeView& mesh)
+{
+    return (mesh.normals ? HAS_NORMALS : 0) | (mesh.uvs ? HAS_UVS : 0) | ((mesh.tangents && mesh.bitangents) ? HAS_TANGENTS_AND_BITANGENTS : 0);
+}
+
+size_t GetChunkDataSize(uint32_t attributes, uint64_t totalVertices, uint64_t totalIndices)
+{
+    size_t bytesPerVertex = sizeof(glm::vec3);
+    if (attributes & HAS_NORMALS) {
+        bytesPerVertex += sizeof(glm::vec3);
+    }
+    if (attributes & HAS_UVS) {
+        bytesPerVertex += sizeof(glm::vec2);
+    }
+    if (attributes & HAS_TANGENTS_AND_BITANGENTS) {
+        bytesPerVertex += 2 * sizeof(glm::vec3);
+    }
+    return static_cast<size_t>(totalVertices * bytesPerVertex + totalIndices * sizeof(unsigned int));
+}
+
+// Splits triangles[begin, end) at the median centroid along the longest axis until every chunk is small enough.
+void SplitTriangles(const std::vector<glm::vec3>& centroids, std::vector<unsigned int>& triangles, size_t begin, size_t end,
+    size_t maxTrianglesPerChunk, std::vector<std::pair<size_t, size_t>>& outputChunks)
+{
+    if (end - begin <= maxTrianglesPerChunk) {
+        outputChunks.emplace_back(begin, end);
+        return;
+    }
+
+    Box centroidBounds;
+    for (size_t i = begin; i < end; ++i) {
+        centroidBounds.IncludeBox(Box(centroids[triangles[i]], centroids[triangles[i]]));
+    }
+    const glm::vec3 extent = centroidBounds.maxVertex - centroidBounds.minVertex;
+    int splitDim = 0;
+    if (extent.y > extent[splitDim]) {
+        splitDim = 1;
+    }
+    if (extent.z > extent[splitDim]) {
+        splitDim = 2;
+    }
+
+    const size_t middle = begin + (end - begin) / 2;
+    std::nth_element(triangles.begin() + begin, triangles.begin() + middle, triangles.begin() + end, [&](unsigned int a, unsigned int b) {
+        return centroids[a][splitDim] < centroids[b][splitDim];
+    });
+    SplitTriangles(centroids, triangles, begin, middle, maxTrianglesPerChunk, outputChunks);
+    SplitTriangles(centroids, triangles, middle, end, maxTrianglesPerChunk, outputChunks);
+}
+
+template<typename T>
+void WriteGathered(BinaryWriter& writer, const T* source, const std::vector<unsigned int>& vertices, std::vector<T>& scratch)
+{
+    scratch.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        scratch[i] = source[vertices[i]];
+    }
+    writer.Write(scratch.data(), sizeof(T) * scratch.size());
+}
+
+}
+
+const uint32_t GeometryChunkFile::CURRENT_VERSION = 2;
+
+GeometryChunkFile::GeometryChunkFile() :
+    storedSourceHash(0)
+{
+}
+
+std::string GeometryChunkFile::GetChunkFilePath(const std::string& sourceFilename)
+{
+    return sourceFilename + ".rtchunks";
+}
+
+bool GeometryChunkFile::Open(const std::string& chunkFilename, int64_t sourceTimestamp, uint64_t sourceSize, uint32_t maxTrianglesPerChunk)
+{
+    Close();
+    if (!mappedFile.Open(chunkFilename)) {
+        return false;
+    }
+
+    GeometryChunkHeader header;
+    BinaryReader headerReader(mappedFile.GetData(), mappedFile.GetSize());
+    if (!headerReader.Read(header) || header.magic != GEOMETRY_CHUNK_MAGIC || header.version != CURRENT_VERSION ||
+        header.maxTrianglesPerChunk != maxTrianglesPerChunk || header.sourceTimestamp != sourceTimestamp || header.sourceSize != sourceSize) {
+        Close();
+        return false;
+    }
+
+    bool isValid = header.tableOffset <= mappedFile.GetSize() && header.tableOffset % 4 == 0;
+    BinaryReader reader(mappedFile.GetData() + (isValid ? header.tableOffset : 0), isValid ? mappedFile.GetSize() - header.tableOffset : 0);
+    for (uint32_t m = 0; m < header.totalMeshes && isValid; ++m) {
+        GeometryChunkMeshHeader meshHeader;
+        const char* name = nullptr;
+        if (!reader.Read(meshHeader) || !reader.ReadArray(name, meshHeader.nameLength)) {
+            isValid = false;
+            break;
+        }
+
+        MeshRecord mesh;
+        mesh.name.assign(name, meshHeader.nameLength);
+        mesh.materialIndex = meshHeader.materialIndex;
+        mesh.attributes = meshHeader.attributes;
+        for (uint32_t c = 0; c < meshHeader.totalChunks && isValid; ++c) {
+            GeometryChunkTableEntry entry;
+            isValid = reader.Read(entry) && entry.offset % 4 == 0 && entry.offset <= header.tableOffset &&
+                GetChunkDataSize(mesh.attributes, entry.totalVertices, entry.totalIndices) <= header.tableOffset - entry.offset;
+            if (!isValid) {
+                break;
+            }
+
+            ChunkRecord chunk;
+            chunk.bounds = Box(glm::vec3(entry.minVertex[0], entry.minVertex[1], entry.minVertex[2]), glm::vec3(entry.maxVertex[0], entry.maxVertex[1], entry.maxVertex[2]));
+            chunk.totalVertices = entry.totalVertices;
+            chunk.totalIndices = entry.totalIndices;
+            chunk.offset = entry.offset;
+            mesh.chunks.push_back(chunk);
+        }
+        isValid = isValid && mesh.materialIndex < header.totalMaterials;
+        meshes.push_back(std::move(mesh));
+    }
+
+    for (uint32_t m = 0; m < header.totalMaterials && isValid; ++m) {
+        materialRecords.push_back(reader.Current());
+        isValid = MaterialSerialization::SkipMaterial(reader);
+    }
+
+    if (!isValid) {
+        std::cerr << "WARNING: Geometry chunk file " << chunkFilename << " is malformed. Ignoring it." << std::endl;
+        Close();
+        return false;
+    }
+    storedSourceHash = header.sourceHash;
+    return true;
+}
+
+void GeometryChunkFile::Close()
+{
+    meshes.clear();
+    materialRecords.clear();
+    storedSourceHash = 0;
+    mappedFile.Close();
+}
+
+bool GeometryChunkFile::GetChunkView(size_t meshIndex, size_t chunkIndex, MeshAttributeView& outputView) const
+{
+    assert(meshIndex < meshes.size() && chunkIndex < meshes[meshIndex].chunks.size());
+    const MeshRecord& mesh = meshes[meshIndex];
+    const ChunkRecord& chunk = mesh.chunks[chunkIndex];
+
+    // The table entry was checked against the file size in Open() so only the index contents are left to validate.
+    BinaryReader reader(mappedFile.GetData() + chunk.offset, mappedFile.GetSize() - static_cast<size_t>(chunk.offset));
+    outputView = MeshAttributeView();
+    outputView.name = mesh.name;
+    outputView.materialIndex = mesh.materialIndex;
+    outputView.totalVertices = chunk.totalVertices;
+    outputView.totalIndices = chunk.totalIndices;
+    reader.ReadArray(outputView.positions, chunk.totalVertices);
+    if (mesh.attributes & HAS_NORMALS) {
+        reader.ReadArray(outputView.normals, chunk.totalVertices);
+    }
+    if (mesh.attributes & HAS_UVS) {
+        reader.ReadArray(outputView.uvs, chunk.totalVertices);
+    }
+    if (mesh.attributes & HAS_TANGENTS_AND_BITANGENTS) {
+        reader.ReadArray(outputView.tangents, chunk.totalVertices);
+        reader.ReadArray(outputView.bitangents, chunk.totalVertices);
+    }
+    reader.ReadArray(outputView.indices, chunk.totalIndices);
+
+    bool isValid = chunk.totalIndices % 3 == 0;
+    for (uint32_t i = 0; i < chunk.totalIndices && isValid; ++i) {
+        isValid = outputView.indices[i] < chunk.totalVertices;
+    }
+    return isValid;
+}
+
+std::shared_ptr<aiMaterial> GeometryChunkFile::CreateMaterial(size_t index) const
+{
+    assert(index < materialRecords.size());
+    // The record was already validated in Open().
+    BinaryReader reader(materialRecords[index], mappedFile.GetSize() - (materialRecords[index] - mappedFile.GetData()));
+    return MaterialSerialization::ReadMaterial(reader);
+}
+
+bool GeometryChunkFile::Write(const std::string& chunkFilename, int64_t sourceTimestamp, uint64_t sourceSize, uint64_t sourceHash, uint32_t maxTrianglesPerChunk,
+    const std::vector<MeshAttributeView>& meshes, const std::vector<const aiMaterial*>& meshMaterials)
+{
+    assert(maxTrianglesPerChunk > 0 && meshMaterials.size() == meshes.size());
+
+    // Meshes that share a material share its record.
+    std::vector<const aiMaterial*> materials;
+    std::vector<uint32_t> meshMaterialIndices(meshes.size());
+    for (size_t m = 0; m < meshes.size(); ++m) {
+        assert(meshMaterials[m]);
+        meshMaterialIndices[m] = static_cast<uint32_t>(std::find(materials.begin(), materials.end(), meshMaterials[m]) - materials.begin());
+        if (meshMaterialIndices[m] == materials.size()) {
+            materials.push_back(meshMaterials[m]);
+        }
+    }
+
+    const std::string temporaryFilename = MappedFile::GetTemporaryFilename(chunkFilename);
+    {
+        std::ofstream stream(temporaryFilename, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            return false;
+        }
+        BinaryWriter writer(stream);
+
+        GeometryChunkHeader header;
+        header.magic = GEOMETRY_CHUNK_MAGIC;
+        header.version = CURRENT_VERSION;
+        header.maxTrianglesPerChunk = maxTrianglesPerChunk;
+        header.totalMeshes = static_cast<uint32_t>(meshes.size());
+        header.totalMaterials = static_cast<uint32_t>(materials.size());
+        header.reserved = 0;
+        header.sourceTimestamp = sourceTimestamp;
+        header.sourceSize = sourceSize;
+        header.sourceHash = sourceHash;
+        header.tableOffset = 0;
+        writer.Write(header);
+
+        // The chunk data goes first and the table is appended once all of the offsets are known.
+        std::vector<std::vector<GeometryChunkTableEntry>> meshEntries(meshes.size());
+        std::vector<glm::vec3> vec3Scratch;
+        std::vector<glm::vec2> vec2Scratch;
+        for (size_t m = 0; m < meshes.size(); ++m) {
+            const MeshAttributeView& mesh = meshes[m];
+            const uint32_t attributes = GetAttributes(mesh);
+            const size_t totalTriangles = mesh.totalIndices / 3;
+
+            std::vector<glm::vec3> centroids(totalTriangles);
+            std::vector<unsigned int> triangles(totalTriangles);
+            for (size_t t = 0; t < totalTriangles; ++t) {
+                const unsigned int* face = mesh.indices + t * 3;
+                centroids[t] = (mesh.positions[face[0]] + mesh.positions[face[1]] + mesh.positions[face[2]]) / 3.f;
+                triangles[t] = static_cast<unsigned int>(t);
+            }
+
+            std::vector<std::pair<size_t, size_t>> chunkRanges;
+            if (totalTriangles) {
+                SplitTriangles(centroids, triangles, 0, totalTriangles, maxTrianglesPerChunk, chunkRanges);
+            }
+
+            // Maps mesh vertices to chunk-local vertices. Entries are reset after every chunk.
+            std::vector<unsigned int> localVertexIndex(mesh.totalVertices, std::numeric_limits<unsigned int>::max());
+            std::vector<unsigned int> chunkVertices;
+            std::vector<unsigned int> chunkIndices;
+            for (size_t c = 0; c < chunkRanges.size(); ++c) {
+                chunkVertices.clear();
+                chunkIndices.clear();
+                Box bounds;
+                for (size_t t = chunkRanges[c].first; t < chunkRanges[c].second; ++t) {
+                    for (int v = 0; v < 3; ++v) {
+                        const unsigned int vertex = mesh.indices[triangles[t] * 3 + v];
+                        if (localVertexIndex[vertex] == std::numeric_limits<unsigned int>::max()) {
+                            localVertexIndex[vertex] = static_cast<unsigned int>(chunkVertices.size());
+                            chunkVertices.push_back(vertex);
+                            bounds.IncludeBox(Box(mesh.positions[vertex], mesh.positions[vertex]));
+                        }
+                        chunkIndices.push_back(localVertexIndex[vertex]);
+                    }
+                }
+
+                GeometryChunkTableEntry entry;
+                for (int i = 0; i < 3; ++i) {
+                    entry.minVertex[i] = bounds.minVertex[i];
+                    entry.maxVertex[i] = bounds.maxVertex[i];
+                }
+                entry.totalVertices = static_cast<uint32_t>(chunkVertices.size());
+                entry.totalIndices = static_cast<uint32_t>(chunkIndices.size());
+                entry.offset = static_cast<uint64_t>(stream.tellp());
+                meshEntries[m].push_back(entry);
+
+                WriteGathered(writer, mesh.positions, chunkVertices, vec3Scratch);
+                if (attributes & HAS_NORMALS) {
+                    WriteGathered(writer, mesh.normals, chunkVertices, vec3Scratch);
+                }
+                if (attributes & HAS_UVS) {
+                    WriteGathered(writer, mesh.uvs, chunkVertices, vec2Scratch);
+                }
+                if (attributes & HAS_TANGENTS_AND_BITANGENTS) {
+                    WriteGathered(writer, mesh.tangents, chunkVertices, vec3Scratch);
+                    WriteGathered(writer, mesh.bitangents, chunkVertices, vec3Scratch);
+                }
+                writer.Write(chunkIndices.data(), sizeof(unsigned int) * chunkIndices.size());
+
+                for (size_t i = 0; i < chunkVertices.size(); ++i) {
+                    localVertexIndex[chunkVertices[i]] = std::numeric_limits<unsigned int>::max();
+                }
+            }
+        }
+
+        header.tableOffset = static_cast<uint64_t>(stream.tellp());
+        for (size_t m = 0; m < meshes.size(); ++m) {
+            GeometryChunkMeshHeader meshHeader;
+            meshHeader.nameLength = static_cast<uint32_t>(meshes[m].name.size());
+            meshHeader.materialIndex = meshMaterialIndices[m];
+            meshHeader.attributes = GetAttributes(meshes[m]);
+            meshHeader.totalChunks = static_cast<uint32_t>(meshEntries[m].size());
+            writer.Write(meshHeader);
+            writer.Write(meshes[m].name.data(), meshes[m].name.size());
+            for (size_t c = 0; c < meshEntries[m].size(); ++c) {
+                writer.Write(meshEntries[m][c]);
+            }
+        }
+        for (size_t m = 0; m < materials.size(); ++m) {
+            MaterialSerialization::WriteMaterial(writer, *materials[m]);
+        }
+
+        stream.seekp(0);
+        writer.Write(header);
+        if (!stream) {
+            stream.close();
+            std::remove(temporaryFilename.c_str());
+            return false;
+        }
+    }
+
+    if (!MappedFile::ReplaceFile(temporaryFilename, chunkFilename)) {
+        std::remove(temporaryFilename.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Scene/Geometry/Simple/Box/Box.h"
+#include "common/Utility/File/MappedFile.h"
+#include "common/Utility/Mesh/Loading/MeshAttributeView.h"
+
+struct aiMaterial;
+
+// On-disk layout used by streaming meshes. Each mesh is split into spatially coherent chunks of a bounded number of
+// triangles; every chunk stores its own indexed vertex data so it can be paged in on its own. Opening the file only
+// reads the chunk table (names, bounds, offsets and the materials), the chunk data is touched when GetChunkView is
+// called. The file holds everything a streaming mesh needs, so the source asset is not read again while it is valid.
+class GeometryChunkFile
+{
+public:
+    struct ChunkRecord
+    {
+        Box bounds;
+        uint32_t totalVertices;
+        uint32_t totalIndices;
+        uint64_t offset;
+    };
+
+    struct MeshRecord
+    {
+        std::string name;
+        // Into the materials of this file (see CreateMaterial).
+        unsigned int materialIndex;
+        uint32_t attributes;
+        std::vector<ChunkRecord> chunks;
+    };
+
+    static const uint32_t CURRENT_VERSION;
+
+    GeometryChunkFile();
+
+    static std::string GetChunkFilePath(const std::string& sourceFilename);
+
+    // Returns false if the file is missing, malformed, from another version or does not match the source. The source is
+    // matched by timestamp and size only: hashing it would read all of an asset that may not fit in memory.
+    bool Open(const std::string& chunkFilename, int64_t sourceTimestamp, uint64_t sourceSize, uint32_t maxTrianglesPerChunk);
+    void Close();
+
+    const std::vector<MeshRecord>& GetMeshes() const { return meshes; }
+    size_t GetTotalMaterials() const { return materialRecords.size(); }
+    std::shared_ptr<aiMaterial> CreateMaterial(size_t index) const;
+
+    // Hash of the source file the chunks were cut from.
+    uint64_t GetSourceHash() const { return storedSourceHash; }
+
+    // Points the view at the chunk data inside the mapping. Returns false if the chunk is malformed. The view stays valid
+    // for as long as the file is open.
+    bool GetChunkView(size_t meshIndex, size_t chunkIndex, MeshAttributeView& outputView) const;
+
+    // meshMaterials holds the material of every mesh.
+    static bool Write(const std::string& chunkFilename, int64_t sourceTimestamp, uint64_t sourceSize, uint64_t sourceHash, uint32_t maxTrianglesPerChunk,
+        const std::vector<MeshAttributeView>& meshes, const std::vector<const aiMaterial*>& meshMaterials);
+private:
+    MappedFile mappedFile;
+    std::vector<MeshRecord> meshes;
+    std::vector<const unsigned char*> materialRecords;
+    uint64_t storedSourceHash;
+};
@@ -0,0 +1,166 @@
+#include "common/Utility/Random/Random.h"
+#include "common/Utility/Hash/Hash.h"
+
+namespace Random
+{
+
+namespace
+{
+
+const uint32_t PHILOX_M0 = 0xD2511F53u;
+const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+const uint32_t PHILOX_W0 = 0x9E3779B9u;
+const uint32_t PHILOX_W1 = 0xBB67AE85u;
+const int PHILOX_ROUNDS = 10;
+
+const uint32_t INVALID_BLOCK = 0xFFFFFFFFu;
+
+inline void MultiplyHighLow(uint32_t a, uint32_t b, uint32_t& high, uint32_t& low)
+{
+    const uint64_t product = static_cast<uint64_t>(a) * static_cast<uint64_t>(b);
+    high = static_cast<uint32_t>(product >> 32);
+    low = static_cast<uint32_t>(product);
+}
+
+}
+
+void Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t output[4])
+{
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        uint32_t high0, low0, high1, low1;
+        MultiplyHighLow(PHILOX_M0, c0, high0, low0);
+        MultiplyHighLow(PHILOX_M1, c2, high1, low1);
+        c0 = high1 ^ c1 ^ k0;
+        c1 = low1;
+        c2 = high0 ^ c3 ^ k1;
+        c3 = low0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    output[0] = c0;
+    output[1] = c1;
+    output[2] = c2;
+    output[3] = c3;
+}
+
+Generator::Generator(uint64_t key, uint64_t sampleIndex)
+{
+    Reset(key, sampleIndex);
+}
+
+void Generator::Reset(uint64_t inputKey, uint64_t inputSampleIndex)
+{
+    key = inputKey;
+    sequence = nullptr;
+    totalSequenceSamples = 0;
+    SetSampleIndex(inputSampleIndex);
+}
+
+void Generator::SetSampleIndex(uint64_t inputSampleIndex)
+{
+    sampleIndex = inputSampleIndex;
+    sequenceIndex = inputSampleIndex;
+    dimension = 0;
+    cachedBlockIndex = INVALID_BLOCK;
+}
+
+uint32_t Generator::NextUInt()
+{
+    const uint32_t blockIndex = dimension / 4;
+    if (blockIndex != cachedBlockIndex) {
+        const uint32_t counter[4] = { static_cast<uint32_t>(sampleIndex), static_cast<uint32_t>(sampleIndex >> 32), blockIndex, 0 };
+        const uint32_t philoxKey[2] = { static_cast<uint32_t>(key), static_cast<uint32_t>(key >> 32) };
+        Philox4x32(counter, philoxKey, cachedBlock);
+        cachedBlockIndex = blockIndex;
+    }
+    return cachedBlock[dimension++ % 4];
+}
+
+float Generator::NextFloat()
+{
+    if (sequence && dimension < sequence->GetTotalDimensions()) {
+        return sequence->Evaluate(sequenceIndex, dimension++, key);
+    }
+
+    // The top 24 bits fill the float mantissa exactly, so the result never rounds up to 1.
+    return static_cast<float>(NextUInt() >> 8) * (1.f / 16777216.f);
+}
+
+Generator Generator::Split()
+{
+    if (!sequence) {
+        const uint64_t high = NextUInt();
+        const uint64_t low = NextUInt();
+        return Generator((high << 32) | low, 0);
+    }
+
+    // The child evaluates the same sample of the sequence under its own scramble. Shuffling the order in which it visits
+    // the samples keeps its points from lining up with the parent's while every sample still gets a point of the set.
+    Generator child(MakeKey(key, dimension), sampleIndex);
+    child.sequence = sequence;
+    child.totalSequenceSamples = totalSequenceSamples;
+    if (sampleIndex < totalSequenceSamples) {
+        child.sequenceIndex = PermuteIndex(static_cast<uint32_t>(sampleIndex), totalSequenceSamples, static_cast<uint32_t>(child.key));
+    }
+    dimension += 2;
+    return child;
+}
+
+void Generator::SetSequence(const Sequence* inputSequence, uint32_t totalSamples)
+{
+    sequence = inputSequence;
+    totalSequenceSamples = totalSamples;
+}
+
+uint32_t PermuteIndex(uint32_t index, uint32_t totalElements, uint32_t seed)
+{
+    uint32_t mask = totalElements - 1;
+    mask |= mask >> 1;
+    mask |= mask >> 2;
+    mask |= mask >> 4;
+    mask |= mask >> 8;
+    mask |= mask >> 16;
+
+    // Hash within the next power of two and cycle-walk until the result falls inside the range.
+    do {
+        index ^= seed;
+        index *= 0xe170893du;
+        index ^= seed >> 16;
+        index ^= (index & mask) >> 4;
+        index ^= seed >> 8;
+        index *= 0x0929eb3fu;
+        index ^= seed >> 23;
+        index ^= (index & mask) >> 1;
+        index *= 1 | seed >> 27;
+        index *= 0x6935fa69u;
+        index ^= (index & mask) >> 11;
+        index *= 0x74dcb303u;
+        index ^= (index & mask) >> 2;
+        index *= 0x9e501cc3u;
+        index ^= (index & mask) >> 2;
+        index *= 0xc860a3dfu;
+        index &= mask;
+        index ^= index >> 5;
+    } while (index >= totalElements);
+    return (index + seed) % totalElements;
+}
+
+uint64_t MakeKey(uint64_t first, uint64_t second)
+{
+    return Hash::HashCombine(Hash::HashValue(first), second);
+}
+
+uint64_t PixelKey(int x, int y)
+{
+    return MakeKey(static_cast<uint64_t>(static_cast<uint32_t>(x)), static_cast<uint64_t>(static_cast<uint32_t>(y)));
+}
+
+Generator& GetThreadGenerator()
+{
+    static thread_local Generator generator;
+    return generator;
+}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef __RANDOM__
+#define __RANDOM__
+
+#include "common/common.h"
+
+namespace Random
+{
+// A deterministic point set (Sobol, Halton, ...) that a Generator can draw its first GetTotalDimensions() dimensions
+// from instead of Philox. Point `index` must be randomized by `scramble` so that every stream key gets its own
+// variant of the set.
+class Sequence
+{
+public:
+    virtual ~Sequence() {}
+
+    virtual uint32_t GetTotalDimensions() const = 0;
+    virtual float Evaluate(uint64_t index, uint32_t dimension, uint64_t scramble) const = 0;
+};
+
+// Counter-based generator on top of Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+// Every number is a pure function of (key, sample index, dimension): there is no state shared between threads and a
+// given pixel sample sees the same numbers no matter which thread renders it or in which order. The key identifies the
+// stream (usually a pixel, see PixelKey); the dimension advances by one for every number that is drawn.
+class Generator
+{
+public:
+    Generator(uint64_t key = 0, uint64_t sampleIndex = 0);
+
+    // Moves to another sample of another stream and starts over at dimension 0. Drops the sequence, if any.
+    void Reset(uint64_t key, uint64_t sampleIndex);
+
+    // Moves to another sample of the same stream and starts over at dimension 0.
+    void SetSampleIndex(uint64_t inputSampleIndex);
+
+    uint32_t NextUInt();
+
+    // Uniform in [0, 1).
+    float NextFloat();
+
+    // Returns an independent stream seeded from the next two dimensions of this one. Use this to hand a sub-system its
+    // own stream without having to know how many numbers it is going to draw.
+    Generator Split();
+
+    // Takes the first sequence->GetTotalDimensions() dimensions of every sample from the sequence, using the sample
+    // index as the point index and the key as the scramble; later dimensions still come from Philox. totalSamples is
+    // the number of samples that are going to be taken with this key. Streams made by Split() keep the sequence but
+    // visit those samples in a shuffled order, so their dimensions are not correlated with the ones of the parent.
+    // Pass nullptr to go back to plain Philox.
+    void SetSequence(const Sequence* inputSequence, uint32_t totalSamples);
+
+    uint64_t GetKey() const { return key; }
+    uint64_t GetSampleIndex() const { return sampleIndex; }
+    uint32_t GetDimension() const { return dimension; }
+    void SetDimension(uint32_t inputDimension) { dimension = inputDimension; }
+
+private:
+    uint64_t key;
+    uint64_t sampleIndex;
+    uint32_t dimension;
+
+    const Sequence* sequence;
+    uint32_t totalSequenceSamples;
+    uint64_t sequenceIndex;
+
+    // Philox produces four numbers per evaluation; the last block is kept around for the next three draws.
+    uint32_t cachedBlock[4];
+    uint32_t cachedBlockIndex;
+};
+
+// One evaluation of Philox4x32-10.
+void Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t output[4]);
+
+// Maps index to a position in [0, totalElements) such that every index in that range lands on a different position,
+// with a different shuffle for every seed (Kensler, "Correlated Multi-Jittered Sampling").
+uint32_t PermuteIndex(uint32_t index, uint32_t totalElements, uint32_t seed);
+
+// Derives a stream key from two values (e.g. a light index and the photon map it is shooting for).
+uint64_t MakeKey(uint64_t first, uint64_t second);
+
+uint64_t PixelKey(int x, int y);
+
+// The generator of the calling thread. RayTracer re-keys it for every camera sample (see
+// ColorSampler::ComputeSamplesAndColor) and the photon mapper for every photon; code that has no sampler state of its
+// own, like the lights, the thin-lens camera and Russian roulette, draws from it.
+Generator& GetThreadGenerator();
+}
+
+#endif
@@ -0,0 +1,71 @@
+#include "common/Utility/Threading/ParallelFor.h"
+#include <atomic>
+#include <thread>
+
+namespace Threading
+{
+
+namespace
+{
+
+std::atomic<unsigned int> requestedThreads(0);
+
+// Set on every thread that is currently running a ParallelFor body.
+thread_local bool insideParallelFor = false;
+
+}
+
+unsigned int GetTotalThreads()
+{
+    const unsigned int requested = requestedThreads.load();
+    if (requested) {
+        return requested;
+    }
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void SetTotalThreads(unsigned int totalThreads)
+{
+    requestedThreads = totalThreads;
+}
+
+void ParallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& body)
+{
+    if (begin >= end) {
+        return;
+    }
+
+    grainSize = std::max(grainSize, static_cast<size_t>(1));
+    const size_t totalChunks = (end - begin + grainSize - 1) / grainSize;
+    const size_t totalWorkers = std::min(static_cast<size_t>(GetTotalThreads()), totalChunks);
+    if (insideParallelFor || totalWorkers <= 1) {
+        for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize) {
+            body(chunkBegin, std::min(chunkBegin + grainSize, end));
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextChunk(0);
+    auto worker = [&]() {
+        insideParallelFor = true;
+        for (size_t chunk = nextChunk++; chunk < totalChunks; chunk = nextChunk++) {
+            const size_t chunkBegin = begin + chunk * grainSize;
+            body(chunkBegin, std::min(chunkBegin + grainSize, end));
+        }
+        insideParallelFor = false;
+    };
+
+    // The calling thread does its share of the work instead of just waiting.
+    std::vector<std::thread> threads;
+    threads.reserve(totalWorkers - 1);
+    for (size_t i = 1; i < totalWorkers; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+}
+
+}
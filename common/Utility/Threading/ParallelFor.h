@@ -0,0 +1,25 @@
+#pragma once
+
+#ifndef __PARALLEL_FOR__
+#define __PARALLEL_FOR__
+
+#include "common/common.h"
+
+namespace Threading
+{
+// Number of threads ParallelFor will use (including the calling thread). Defaults to the hardware concurrency.
+unsigned int GetTotalThreads();
+
+// Pass 0 to go back to using the hardware concurrency.
+void SetTotalThreads(unsigned int totalThreads);
+
+// Splits [begin, end) into chunks of at most grainSize elements and calls body(chunkBegin, chunkEnd) for each chunk,
+// spreading the chunks over the worker threads. Returns once every chunk has finished. The order in which chunks run is
+// unspecified so the body must only write to data owned by its own range.
+//
+// A ParallelFor issued from inside another ParallelFor body runs serially on the calling thread so that nested loops
+// do not oversubscribe the machine.
+void ParallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& body);
+}
+
+#endif
@@ -18,3 +18,4 @@
 #include "common/Rendering/Renderer.h"
 #include "common/Rendering/Renderer/Backward/BackwardRenderer.h"
 #include "common/Rendering/Renderer/Photon/PhotonMappingRenderer.h"
+#include "common/Rendering/Renderer/Photon/ProgressivePhotonMappingRenderer.h"
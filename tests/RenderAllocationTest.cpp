@@ -0,0 +1,177 @@
+#include "common/core.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Intersection/IntersectionState.h"
+#include "common/Intersection/IntersectionStateArena.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Renders a small Cornell box twice, the way RayTracer samples it, and fails if the second image made any heap
+// allocation. The first image warms up everything that is allocated once per thread (the intersection arena, the
+// sampler states and the light sample buffers). Every global operator new of the process goes through the counter below.
+
+namespace
+{
+
+std::atomic<size_t> totalAllocations(0);
+
+void* CountedAllocate(size_t size)
+{
+    ++totalAllocations;
+    return std::malloc(size ? size : 1);
+}
+
+const int MAX_REFLECTION_BOUNCES = 3;
+const int MAX_REFRACTION_BOUNCES = 3;
+const int IMAGE_WIDTH = 32;
+const int IMAGE_HEIGHT = 24;
+const int SAMPLES_PER_PIXEL = 4;
+
+std::shared_ptr<Scene> CreateScene()
+{
+    std::shared_ptr<Scene> newScene = std::make_shared<Scene>();
+
+    std::shared_ptr<BlinnPhongMaterial> boxMaterial = std::make_shared<BlinnPhongMaterial>();
+    boxMaterial->SetDiffuse(glm::vec3(1.f, 1.f, 1.f));
+    boxMaterial->SetSpecular(glm::vec3(0.6f, 0.6f, 0.6f), 40.f);
+
+    // The two blocks reflect and refract so that every camera ray builds a full ray tree.
+    std::vector<std::shared_ptr<aiMaterial>> loadedMaterials;
+    std::vector<std::shared_ptr<MeshObject>> boxObjects = MeshLoader::LoadMesh("CornellBox/CornellBox-Original.obj", &loadedMaterials);
+    for (size_t i = 0; i < boxObjects.size(); ++i) {
+        std::shared_ptr<Material> materialCopy = boxMaterial->Clone();
+        materialCopy->LoadMaterialFromAssimp(loadedMaterials[i]);
+        if (i < 2) {
+            materialCopy->SetReflectivity(0.3f);
+            materialCopy->SetTransmittance(0.6f);
+            materialCopy->SetIOR(1.5f);
+        }
+        boxObjects[i]->SetMaterial(materialCopy);
+    }
+
+    std::shared_ptr<SceneObject> boxSceneObject = std::make_shared<SceneObject>();
+    boxSceneObject->AddMeshObject(boxObjects);
+    boxSceneObject->Rotate(glm::vec3(1.f, 0.f, 0.f), PI / 2.f);
+    boxSceneObject->CreateAccelerationData(AccelerationTypes::BVH);
+    newScene->AddSceneObject(boxSceneObject);
+
+    std::shared_ptr<AreaLight> areaLight = std::make_shared<AreaLight>(glm::vec2(0.5f, 0.5f));
+    areaLight->SetSamplerAttributes(glm::vec3(2.f, 2.f, 1.f), 4);
+    areaLight->SetPosition(glm::vec3(-0.005f, -0.01f, 1.5328f));
+    areaLight->SetLightColor(glm::vec3(1.f, 1.f, 1.f));
+    newScene->AddLight(areaLight);
+
+    std::shared_ptr<PointLight> pointLight = std::make_shared<PointLight>();
+    pointLight->SetPosition(glm::vec3(0.5f, -1.f, 1.f));
+    pointLight->SetLightColor(glm::vec3(0.3f, 0.3f, 0.3f));
+    newScene->AddLight(pointLight);
+    return newScene;
+}
+
+}
+
+void* operator new(size_t size)
+{
+    void* memory = CountedAllocate(size);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+int main(int argc, char** argv)
+{
+    const glm::vec2 resolution(static_cast<float>(IMAGE_WIDTH), static_cast<float>(IMAGE_HEIGHT));
+    std::shared_ptr<PerspectiveCamera> camera = std::make_shared<PerspectiveCamera>(resolution.x / resolution.y, 26.6f);
+    camera->SetPosition(glm::vec3(0.f, -4.1469f, 0.73693f));
+    camera->Rotate(glm::vec3(1.f, 0.f, 0.f), PI / 2.f);
+
+    std::shared_ptr<Scene> scene = CreateScene();
+    std::shared_ptr<JitterColorSampler> sampler = std::make_shared<JitterColorSampler>();
+    sampler->SetGridSize(glm::ivec3(2, 2, 1));
+    std::shared_ptr<BackwardRenderer> renderer = std::make_shared<BackwardRenderer>(scene, sampler);
+    renderer->SetLightSampling(1);
+
+    scene->SetSecondaryRayCulling(0.01f, true);
+    sampler->InitializeSampler(nullptr, scene.get());
+    scene->GenerateDefaultAccelerationData();
+    scene->Finalize();
+    renderer->InitializeRenderer();
+
+    IntersectionStateArena& intersectionArena = IntersectionStateArena::GetThreadArena();
+    intersectionArena.Reserve(MAX_REFLECTION_BOUNCES, MAX_REFRACTION_BOUNCES);
+
+    std::vector<glm::vec3> image(IMAGE_WIDTH * IMAGE_HEIGHT);
+    size_t totalHits = 0;
+    const auto renderImage = [&]() {
+        sampler->ComputeImage(IMAGE_WIDTH, IMAGE_HEIGHT, SAMPLES_PER_PIXEL, 2,
+            [&](int c, int r, glm::vec3 inputSample) {
+                const glm::vec3 sampleOffset = glm::vec3(-0.5f, -0.5f, 0.f) + glm::vec3(1.f, 1.f, 0.f) * inputSample;
+                glm::vec2 normalizedCoordinates(static_cast<float>(c) + sampleOffset.x, static_cast<float>(r) + sampleOffset.y);
+                normalizedCoordinates /= resolution;
+
+                Ray cameraRay;
+                camera->GenerateRayForNormalizedCoordinates(normalizedCoordinates, cameraRay);
+
+                intersectionArena.Reset();
+                IntersectionState rayIntersection(MAX_REFLECTION_BOUNCES, MAX_REFRACTION_BOUNCES);
+                if (!scene->Trace(&cameraRay, &rayIntersection)) {
+                    return glm::vec3();
+                }
+                ++totalHits;
+                return renderer->ComputeSampleColor(rayIntersection, cameraRay);
+            },
+            [&](int c, int r, glm::vec3 pixelColor) {
+                image[r * IMAGE_WIDTH + c] = pixelColor;
+            });
+    };
+
+    renderImage();
+    const size_t warmUpHits = totalHits;
+    const size_t allocationsBefore = totalAllocations.load();
+    renderImage();
+    const size_t steadyStateAllocations = totalAllocations.load() - allocationsBefore;
+
+    std::cout << "Steady-state allocations: " << steadyStateAllocations << " over " << IMAGE_WIDTH * IMAGE_HEIGHT << " pixels ("
+        << warmUpHits << " of " << IMAGE_WIDTH * IMAGE_HEIGHT * SAMPLES_PER_PIXEL << " camera rays hit)" << std::endl;
+    if (warmUpHits == 0) {
+        std::cerr << "ERROR: No camera ray hit the scene." << std::endl;
+        return EXIT_FAILURE;
+    }
+    return (steadyStateAllocations == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}